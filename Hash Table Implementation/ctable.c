@@ -0,0 +1,295 @@
+/* ctable.c
+ * Hash Table Implementation
+ * Fall 2022
+ *
+ * Propose: A hash table that threads can share.  See ctable.h for how the
+ * stripe locks and the slot versions fit together.
+ */
+
+#include <stdlib.h>
+#include <assert.h>
+#include <stdint.h>
+#include "table.h"
+#include "ctable.h"
+#define EMPTYKEY 1000000001
+#define DELETEKEY 1000000002
+#define HASH_MULT 0x9E3779B97F4A7C15ULL   // the multiply-shift constant of table.c
+
+static _Thread_local int ctable_probes; //slots read by this thread's most recent call
+
+/* the top hash_bits of K times HASH_MULT, as TABLE_POW2 in table.c */
+static inline int ctable_home(ctable_t *T, hashkey_t K){
+    return (int) (((uint64_t) (uint32_t) K * HASH_MULT) >> (64 - T->hash_bits));
+}
+
+/* linear probing goes down the table like table.c */
+static inline int ctable_next(ctable_t *T, int index){
+    return (index - 1) & (T->table_size_M - 1);
+}
+
+static inline pthread_mutex_t *ctable_stripe(ctable_t *T, int home){
+    return &T->stripes[home & (CTABLE_STRIPES - 1)].lock;
+}
+
+/* ----- slot versions -----
+ *
+ * a seqlock for each slot.  A writer makes the version odd with a
+ * compare-and-swap, which also keeps out the writers of other stripes,
+ * changes the slot, and makes the version even again.  A reader that saw
+ * the same even version before and after reading the slot read it while
+ * no writer was in it.  The fences are the ones of Boehm's seqlock.
+ */
+
+/* returns the key of the slot and puts its data_ptr in *I, both as they
+ * were at one moment
+ */
+static inline hashkey_t slot_read(ctable_slot_t *slot, data_t *I){
+    unsigned v1, v2;
+    hashkey_t key;
+    do{
+        v1 = atomic_load_explicit(&slot->version, memory_order_acquire);
+        key = atomic_load_explicit(&slot->key, memory_order_relaxed);
+        *I = atomic_load_explicit(&slot->data_ptr, memory_order_relaxed);
+        atomic_thread_fence(memory_order_acquire); //the loads above come before the next one
+        v2 = atomic_load_explicit(&slot->version, memory_order_relaxed);
+    }while((v1 & 1) || v1 != v2); //a writer was in the slot, so read it again
+    return key;
+}
+
+static inline void slot_lock(ctable_slot_t *slot){
+    unsigned v;
+    do{
+        v = atomic_load_explicit(&slot->version, memory_order_relaxed);
+    }while((v & 1) || !atomic_compare_exchange_weak_explicit(&slot->version, &v, v + 1,
+                memory_order_acquire, memory_order_relaxed));
+    atomic_thread_fence(memory_order_release); //readers see the odd version before any change
+}
+
+static inline void slot_unlock(ctable_slot_t *slot){
+    atomic_fetch_add_explicit(&slot->version, 1, memory_order_release);
+}
+
+/* ----- table ----- */
+
+ctable_t *ctable_construct(int table_size){
+    int bits = 2; //4 slots of 16 bytes, the least aligned_alloc can give 64-byte aligned
+    while((1 << bits) < table_size){ //rounds the size up to a power of two
+        bits++;
+    }
+    assert(bits <= 30);
+    ctable_t *T = aligned_alloc(_Alignof(ctable_t), sizeof(ctable_t));
+    assert(T != NULL);
+    T->table_size_M = 1 << bits;
+    T->hash_bits = bits;
+    T->slots = aligned_alloc(64, sizeof(ctable_slot_t) * T->table_size_M); //4 slots per cache line
+    assert(T->slots != NULL);
+    for(int i = 0; i < T->table_size_M; i++){
+        atomic_init(&T->slots[i].version, 0);
+        atomic_init(&T->slots[i].key, EMPTYKEY);
+        atomic_init(&T->slots[i].data_ptr, NULL);
+    }
+    for(int i = 0; i < CTABLE_STRIPES; i++){
+        pthread_mutex_init(&T->stripes[i].lock, NULL);
+    }
+    atomic_init(&T->num_keys_stored_in_table, 0);
+    atomic_init(&T->deletedkeys, 0);
+    atomic_init(&T->compactions, 0);
+    return T;
+}
+
+void ctable_destruct(ctable_t *T){
+    for(int i = 0; i < CTABLE_STRIPES; i++){
+        pthread_mutex_destroy(&T->stripes[i].lock);
+    }
+    free(T->slots); //the data belongs to the caller
+    free(T);
+}
+
+int ctable_insert(ctable_t *T, hashkey_t K, data_t I, data_t *old_I){
+    int home = ctable_home(T, K);
+    pthread_mutex_t *lock = ctable_stripe(T, home);
+    ctable_slot_t *slot;
+    hashkey_t key;
+    data_t J;
+
+    pthread_mutex_lock(lock); //no other thread changes K until the unlock
+    for(;;){ //goes round again if another stripe takes the free slot first
+        int index = home;
+        int free_slot = -1;
+        ctable_probes = 0;
+        for(int probes = 0; probes < T->table_size_M; probes++){
+            slot = &T->slots[index];
+            ctable_probes++;
+            key = slot_read(slot, &J);
+            if(key == K){ //only this stripe changes a slot that holds K
+                slot_lock(slot);
+                atomic_store_explicit(&slot->data_ptr, I, memory_order_relaxed);
+                slot_unlock(slot);
+                pthread_mutex_unlock(lock);
+                if(old_I != NULL){
+                    *old_I = J;
+                }
+                return 1;
+            }
+            if(key == DELETEKEY && free_slot == -1){
+                free_slot = index; //the first deleted slot is reused
+            }
+            if(key == EMPTYKEY){
+                if(free_slot == -1){
+                    free_slot = index;
+                }
+                break;
+            }
+            index = ctable_next(T, index);
+        }
+        if(free_slot == -1){
+            pthread_mutex_unlock(lock);
+            return -1; //every slot is taken
+        }
+        if(atomic_fetch_add(&T->num_keys_stored_in_table, 1) >= T->table_size_M - 1){
+            atomic_fetch_sub(&T->num_keys_stored_in_table, 1);
+            pthread_mutex_unlock(lock);
+            return -1; //full, one slot always stays free as in table.c
+        }
+        slot = &T->slots[free_slot];
+        slot_lock(slot);
+        key = atomic_load_explicit(&slot->key, memory_order_relaxed);
+        if(key == EMPTYKEY || key == DELETEKEY){
+            atomic_store_explicit(&slot->key, K, memory_order_relaxed);
+            atomic_store_explicit(&slot->data_ptr, I, memory_order_relaxed);
+            slot_unlock(slot);
+            if(key == DELETEKEY){
+                atomic_fetch_sub(&T->deletedkeys, 1);
+            }
+            pthread_mutex_unlock(lock);
+            return 0;
+        }
+        slot_unlock(slot);
+        atomic_fetch_sub(&T->num_keys_stored_in_table, 1);
+    }
+}
+
+data_t ctable_delete(ctable_t *T, hashkey_t K){
+    int index = ctable_home(T, K);
+    pthread_mutex_t *lock = ctable_stripe(T, index);
+    ctable_slot_t *slot;
+    hashkey_t key;
+    data_t I = NULL;
+
+    pthread_mutex_lock(lock);
+    ctable_probes = 0;
+    for(int probes = 0; probes < T->table_size_M; probes++){
+        slot = &T->slots[index];
+        ctable_probes++;
+        key = slot_read(slot, &I);
+        if(key == K){
+            // the slot keeps a DELETEKEY so that searches still go past it
+            slot_lock(slot);
+            atomic_store_explicit(&slot->key, DELETEKEY, memory_order_relaxed);
+            atomic_store_explicit(&slot->data_ptr, NULL, memory_order_relaxed);
+            slot_unlock(slot);
+            atomic_fetch_sub(&T->num_keys_stored_in_table, 1);
+            atomic_fetch_add(&T->deletedkeys, 1);
+            pthread_mutex_unlock(lock);
+            return I;
+        }
+        if(key == EMPTYKEY){
+            break;
+        }
+        index = ctable_next(T, index);
+    }
+    pthread_mutex_unlock(lock);
+    return NULL;
+}
+
+data_t ctable_retrieve(ctable_t *T, hashkey_t K){
+    hashkey_t key;
+    data_t I;
+    unsigned c;
+
+    ctable_probes = 0;
+    for(;;){ //goes round again if a compaction moved the keys under the search
+        do{
+            c = atomic_load_explicit(&T->compactions, memory_order_acquire);
+        }while(c & 1);
+        int index = ctable_home(T, K);
+        for(int probes = 0; probes < T->table_size_M; probes++){
+            ctable_probes++;
+            key = slot_read(&T->slots[index], &I);
+            if(key == K){ //K was in the table when the slot was read
+                return I;
+            }
+            if(key == EMPTYKEY){ //only a compaction empties a slot, so K is not further on
+                break;
+            }
+            index = ctable_next(T, index);
+        }
+        atomic_thread_fence(memory_order_acquire); //the slot reads come before the next load
+        if(atomic_load_explicit(&T->compactions, memory_order_relaxed) == c){
+            return NULL;
+        }
+    }
+}
+
+void ctable_compact(ctable_t *T){
+    int M = T->table_size_M;
+    int n = 0;
+    ctable_slot_t *slot;
+    hashkey_t key;
+
+    for(int i = 0; i < CTABLE_STRIPES; i++){ //in order, so two compactions cannot deadlock
+        pthread_mutex_lock(&T->stripes[i].lock);
+    }
+    atomic_fetch_add_explicit(&T->compactions, 1, memory_order_relaxed);
+    for(int i = 0; i < M; i++){ //readers now wait in slot_read
+        slot_lock(&T->slots[i]);
+    }
+    // take the keys out, empty every slot, and insert the keys again
+    hashkey_t *keys = malloc(sizeof(hashkey_t) * M);
+    data_t *data = malloc(sizeof(data_t) * M);
+    assert(keys != NULL && data != NULL);
+    for(int i = 0; i < M; i++){
+        slot = &T->slots[i];
+        key = atomic_load_explicit(&slot->key, memory_order_relaxed);
+        if(key != EMPTYKEY && key != DELETEKEY){
+            keys[n] = key;
+            data[n++] = atomic_load_explicit(&slot->data_ptr, memory_order_relaxed);
+        }
+        atomic_store_explicit(&slot->key, EMPTYKEY, memory_order_relaxed);
+        atomic_store_explicit(&slot->data_ptr, NULL, memory_order_relaxed);
+    }
+    for(int j = 0; j < n; j++){
+        int index = ctable_home(T, keys[j]);
+        while(atomic_load_explicit(&T->slots[index].key, memory_order_relaxed) != EMPTYKEY){
+            index = ctable_next(T, index);
+        }
+        atomic_store_explicit(&T->slots[index].key, keys[j], memory_order_relaxed);
+        atomic_store_explicit(&T->slots[index].data_ptr, data[j], memory_order_relaxed);
+    }
+    free(keys);
+    free(data);
+    atomic_store_explicit(&T->deletedkeys, 0, memory_order_relaxed);
+    for(int i = 0; i < M; i++){
+        slot_unlock(&T->slots[i]);
+    }
+    atomic_fetch_add_explicit(&T->compactions, 1, memory_order_release);
+    for(int i = CTABLE_STRIPES - 1; i >= 0; i--){
+        pthread_mutex_unlock(&T->stripes[i].lock);
+    }
+}
+
+int ctable_entries(ctable_t *T){
+    return atomic_load_explicit(&T->num_keys_stored_in_table, memory_order_relaxed);
+}
+
+int ctable_deletekeys(ctable_t *T){
+    return atomic_load_explicit(&T->deletedkeys, memory_order_relaxed);
+}
+
+int ctable_size(ctable_t *T){
+    return T->table_size_M;
+}
+
+int ctable_stats(void){
+    return ctable_probes;
+}
@@ -0,0 +1,112 @@
+/* ctable.h
+ * Hash Table Implementation
+ * Fall 2022
+ *
+ * Public functions for a hash table that threads can share
+ *
+ * Nothing in table.c is synchronized, and even table_retrieve writes the
+ * probe count into the table_t, so threads that share a table_t have to
+ * hold one mutex around every call.  A ctable_t can be used by many
+ * threads at once:
+ *
+ * ctable_retrieve takes no locks.  Every slot has a version number that
+ * is odd while a writer changes the slot.  A search reads the version,
+ * the key, and the data_ptr, and reads the slot again if the version was
+ * odd or changed in the meantime, so it never returns the data_ptr of a
+ * key that was deleted and replaced while it looked.
+ *
+ * ctable_insert and ctable_delete lock one of CTABLE_STRIPES mutexes,
+ * picked by the home position of K, so two writers of the same key wait
+ * for each other and writers of other keys mostly do not.  A writer that
+ * changes a slot also locks the slot itself through its version, so two
+ * keys from different stripes cannot take the same empty slot.
+ *
+ * The table is linear probing with the multiply-shift hash of TABLE_POW2,
+ * and a delete leaves a DELETEKEY that a later insert can reuse.  Between
+ * calls to ctable_compact slots never become empty again, which is what
+ * lets a search stop at the first empty slot without a lock.  Deleted
+ * slots only go away with ctable_compact, which locks every stripe and
+ * every slot while it moves the keys; a search that ran into a compaction
+ * and did not find its key starts again.  There is no resizing.
+ *
+ * A ctable_t does not own the data: a replace hands the old I back and
+ * ctable_destruct frees nothing, since another thread may still be using
+ * an I that ctable_retrieve returned.  The probe count of the most recent
+ * call is kept for each thread.
+ *
+ * Include table.h first for hashkey_t and data_t.
+ */
+
+#include <pthread.h>
+#include <stdatomic.h>
+
+#define CTABLE_STRIPES 256    /* writer locks, a power of two */
+
+typedef struct ctable_slot_tag {
+    // private members for ctable.c only
+    atomic_uint version;        // odd while a writer changes the slot
+    atomic_int key;
+    _Atomic(data_t) data_ptr;
+} ctable_slot_t;
+
+/* each mutex on its own cache line, so threads that lock neighbouring
+ * stripes do not invalidate each other's line
+ */
+typedef struct ctable_stripe_tag {
+    _Alignas(64) pthread_mutex_t lock;
+} ctable_stripe_t;
+
+typedef struct ctable_tag {
+    // private members for ctable.c only
+    ctable_slot_t *slots;
+    int table_size_M;           // a power of two
+    int hash_bits;
+    ctable_stripe_t stripes[CTABLE_STRIPES];
+    _Alignas(64) atomic_int num_keys_stored_in_table;
+    atomic_int deletedkeys;
+    atomic_uint compactions;    // odd while ctable_compact moves keys
+} ctable_t;
+
+/* allocates an empty table.  The table_size is rounded up to a power of
+ * two; use ctable_size to find the size that was used.
+ */
+ctable_t *ctable_construct(int table_size);
+
+/* frees the table but none of the data.  No other thread may be using
+ * the table.
+ */
+void ctable_destruct(ctable_t *T);
+
+/* Insert (K, I).  If K is already in the table its I is replaced, and the
+ * old I is put in *old_I if old_I is not NULL.
+ * Return:
+ *      0 if (K, I) is inserted,
+ *      1 if K was already in the table, or
+ *     -1 if the table is full.
+ */
+int ctable_insert(ctable_t *T, hashkey_t K, data_t I, data_t *old_I);
+
+/* Delete K and return its I, or NULL if K is not in the table */
+data_t ctable_delete(ctable_t *T, hashkey_t K);
+
+/* Return the I of K, or NULL if K is not in the table.  Takes no locks. */
+data_t ctable_retrieve(ctable_t *T, hashkey_t K);
+
+/* Empty every position marked deleted and move the keys to where an
+ * insert into a table without deleted positions would put them.  Waits
+ * for the inserts and deletes of all stripes, and searches wait for it.
+ * Takes O(M) time.
+ */
+void ctable_compact(ctable_t *T);
+
+/* The number of entries, of positions marked deleted, and of positions.
+ * While other threads insert or delete the first two are only a snapshot.
+ */
+int ctable_entries(ctable_t *T);
+int ctable_deletekeys(ctable_t *T);
+int ctable_size(ctable_t *T);
+
+/* The number of slots read by the calling thread's most recent call to
+ * ctable_insert, ctable_delete, or ctable_retrieve on any ctable_t
+ */
+int ctable_stats(void);
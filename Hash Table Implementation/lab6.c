@@ -6,16 +6,33 @@
  *
  *   -m to set the table size
  *   -a to set the load factor
- *   -h to set the type of probe sequence {linear|double|quad}
+ *   -h to set the type of probe sequence
+ *      {linear|double|quad|robinhood|swiss|cuckoo}
+ *   -P to use a power-of-two table size with a multiply-shift hash (-m is
+ *      rounded up) instead of abs(K) % M
+ *   -S to keep the keys and the data pointers in separate arrays
+ *   -V to store each key's information as an inline value instead of
+ *      behind a malloced int
  *
  * The -r driver builds a table using table_insert and then accesses
  * keys in the table using table_retrieve.  Use
  *   -r run the retrieve driver and specifiy the type of initial table keys 
  *      (rand|seq|fold|worst)
  *   -t to set the number of access trials 
+ *   After the usual measurements it builds the same kind of table with
+ *   abs(K) % M and with the multiply-shift hash of -P, each with and
+ *   without -S, and shows the probes and the time per lookup of each side
+ *   by side.
  *
  * To test using the rehash driver.  The table size must be at least 6
  *   -b
+ * The rehash driver checks the slot each key lands in, so it does not run
+ * with -h swiss or -h cuckoo.
+ *
+ * The unit driver -u 3 checks table_set_autoresize: tables of 1 position
+ * must grow on the first insert, and in a table that churns inserts,
+ * deletes, and retrieves near its max_load the probes of a retrieve must
+ * stay bounded, since the deleted positions must not fill the empty ones.
  *
  * To test the Two Sum Problem use -p X for X=1, 2, 3, or 4
  *    For -p 4 only:
@@ -27,6 +44,73 @@
  * with equal probability.
  *   -e run the equilibrium driver
  *
+ * The load sweep driver compares the time per operation of linear, double,
+ * robinhood, swiss, and cuckoo tables of -m positions at load factors from 0.5 to
+ * 0.95: lookups of keys in the table and of random keys as in -r, and -t
+ * pairs of a delete and an insert as in -e.  With -m prime or with -P so
+ * that double hashing covers the table, e.g. -L -P -m 1000000
+ *   -L run the load sweep driver
+ *
+ * The cuckoo driver fills linear, robinhood, swiss, and cuckoo tables of -m
+ * positions to load factor -a with -i rand or worst keys, and shows the
+ * time per insert and the average and largest number of probes of hits
+ * and misses.  Then it fills the cuckoo table with random keys until an
+ * insert fails.  Worst keys take quadratic time to insert with linear
+ * probing, so keep -m small for them, e.g. -k -i worst -m 20000
+ *   -k run the cuckoo driver
+ *
+ * The growth driver inserts -t random keys into a table that starts with
+ * -m positions, once with table_set_autoresize at load factor -a, and once
+ * calling table_rehash to double the size whenever the next insert would
+ * go over -a.  It shows the time of the average, the slowest 1% and 0.1%,
+ * and the slowest insert, e.g. -g -m 1000 -a 0.8 -t 2000000
+ *   -g run the growth driver
+ *
+ * The batch driver inserts the same random keys into a table of -m
+ * positions to load factor -a, and then looks up -t of them and -t
+ * random keys, one call per key and with table_insert_batch and
+ * table_retrieve_batch in batches of 1, 8, 32, and 128.  Batches only help
+ * when the table is much bigger than the cache, e.g. -B -P -m 16000000
+ *   -B run the batch driver
+ *
+ * The concurrent driver is the equilibrium driver for the ctable_t of
+ * ctable.c, shared by 1, 2, 4, ... up to n threads.  The threads split -t
+ * calls with random keys from a range twice the size of -a of the table,
+ * so about half of them are in the table, and with a mix of 90%, 50%, and
+ * 10% ctable_retrieve; the rest are inserts and deletes in equal numbers.
+ * Deleted slots pile up, since only ctable_compact clears them, so every
+ * 1024 calls a thread calls it if they are more than half of the slots
+ * without a key; the searches of the other threads wait for it.  It shows the
+ * millions of calls per second for each mix and number of threads, the
+ * number of compactions, and the % of deleted slots at the end,
+ * e.g. -C 8 -m 1000000 -t 1000000
+ *   -C n run the concurrent driver with up to n threads
+ *
+ * The sharded driver runs the same calls as the concurrent driver on two
+ * tables of -h probing and -m positions with TABLE_INLINE values: a
+ * table_t behind one mutex, and a table_sharded_t of shtable.c with 64
+ * shards.  The keys are random rather than the range itself, which
+ * abs(K) % M would put in one long cluster and the multiply-shift hash of
+ * one table would spread better than that of a shard, so only the locking
+ * differs.  Both resize themselves when more than 25% of the positions
+ * without a key are deleted, a sharded one one shard at a time.  It shows
+ * the millions of calls per second for each table, mix, and number of
+ * threads, and the entries of the fullest shard over the average,
+ * e.g. -N 8 -m 1000000
+ *   -N n run the sharded driver with up to n threads
+ *
+ * The compact driver runs the equilibrium driver's inserts and deletes
+ * -t times on a table filled to -a, once for each way of dealing with the
+ * positions marked deleted: nothing, table_rehash to the same size,
+ * table_compact, and table_set_autocompact for when half the empty
+ * positions of a table at -a are marked deleted.  Each one runs in its
+ * own process, so the peak resident memory it shows is that of the one
+ * table.  It shows the % deleted positions left, the longest pause (the
+ * one call, or for autocompact the slowest insert or delete), the peak
+ * memory, and the probes and time of unsuccessful searches afterwards,
+ * e.g. -D -V -m 1000003 -t 2000000
+ *   -D run the compact driver
+ *
  */
 #include <stdlib.h>
 #include <stdio.h>
@@ -37,8 +121,14 @@
 #include <time.h>
 #include <unistd.h>
 #include <limits.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
 
 #include "table.h"
+#include "ctable.h"
+#include "shtable.h"
 
 /* constants used with Global variables */
 
@@ -56,10 +146,18 @@ enum TableType_t {RAND, SEQ, FOLD, WORST};
 int Verbose = FALSE;
 static int TableSize = 11;
 static int ProbeDec = LINEAR;
+static int TableOptions = 0;     /* TABLE_ options added to ProbeDec */
 static double LoadFactor = 0.9;
 static int TableType = RAND;
 static int RetrieveTest = FALSE;
 static int EquilibriumTest = FALSE;
+static int LoadSweep = FALSE;
+static int CuckooTest = FALSE;
+static int GrowthTest = FALSE;
+static int BatchTest = FALSE;
+static int ConcurrentThreads = 0;
+static int ShardedThreads = 0;
+static int CompactTest = FALSE;
 static int UnitInt = FALSE;
 static int RehashTest = FALSE;
 static int TwoSumTest = 0;
@@ -77,7 +175,19 @@ int build_random(table_t *T, int ,int);
 int build_seq(table_t *T, int, int);
 int build_fold(table_t *T, int, int);
 int build_worst(table_t *T, int, int);
-void performanceFormulas(double);
+int insert_key(table_t *T, hashkey_t key);
+int find_key(table_t *T, hashkey_t key);
+int remove_key(table_t *T, hashkey_t key);
+void hashCompare(void);
+void loadSweep(void);
+void cuckooDriver(void);
+void growthDriver(void);
+void batchDriver(void);
+void concurrentDriver(int);
+void shardedDriver(int);
+void compactDriver(void);
+void performanceFormulas(double, int);
+void printTableStats(table_t *);
 int find_first_prime(int number);
 void twoSum(const int* nums, const int numsSize, const int target, int *ans1, int *ans2);
 
@@ -91,6 +201,18 @@ int main(int argc, char **argv)
         printf("Open addressing with double hashing\n");
     else if (ProbeDec == QUAD)
         printf("Open addressing with quadratic probe sequence\n");
+    else if (ProbeDec == ROBINHOOD)
+        printf("Open addressing with Robin Hood linear probing\n");
+    else if (ProbeDec == SWISS)
+        printf("Open addressing with Swiss table control bytes\n");
+    else if (ProbeDec == CUCKOO)
+        printf("Bucketized cuckoo hashing\n");
+    if (TableOptions & TABLE_POW2)
+        printf("Power-of-two table size with multiply-shift hash\n");
+    if (TableOptions & TABLE_SOA)
+        printf("Keys and data pointers in separate arrays\n");
+    if (TableOptions & TABLE_INLINE)
+        printf("Inline values instead of data pointers\n");
     printf("Seed: %d\n", Seed);
     srand48(Seed);
 
@@ -110,6 +232,20 @@ int main(int argc, char **argv)
     /* test for performance in equilibrium */
     if (EquilibriumTest)                   /* enable with -e flag */
         equilibriumDriver();
+    if (LoadSweep)                         /* enable with -L flag */
+        loadSweep();
+    if (CuckooTest)                        /* enable with -k flag */
+        cuckooDriver();
+    if (GrowthTest)                        /* enable with -g flag */
+        growthDriver();
+    if (BatchTest)                         /* enable with -B flag */
+        batchDriver();
+    if (ConcurrentThreads > 0)             /* enable with -C flag */
+        concurrentDriver(ConcurrentThreads);
+    if (ShardedThreads > 0)                /* enable with -N flag */
+        shardedDriver(ShardedThreads);
+    if (CompactTest)                       /* enable with -D flag */
+        compactDriver();
     /* test for performance made by Nish */
     if (UnitInt != 0)                   /* enable with -u flag */
         UnitDriver(UnitInt);
@@ -123,16 +259,16 @@ void build_table(table_t *test_table, int num_keys)
     printf("  Build table with");
     if (TableType == RAND) {
         printf(" %d random keys\n", num_keys);
-        probes = build_random(test_table, TableSize, num_keys);
+        probes = build_random(test_table, table_size(test_table), num_keys);
     } else if (TableType == SEQ) {
         printf(" %d sequential keys\n", num_keys);
-        probes = build_seq(test_table, TableSize, num_keys);
+        probes = build_seq(test_table, table_size(test_table), num_keys);
     } else if (TableType == FOLD) {
         printf(" %d folded keys\n", num_keys);
-        probes = build_fold(test_table, TableSize, num_keys);
+        probes = build_fold(test_table, table_size(test_table), num_keys);
     } else if (TableType == WORST) {
         printf(" %d worst keys\n", num_keys);
-        probes = build_worst(test_table, TableSize, num_keys);
+        probes = build_worst(test_table, table_size(test_table), num_keys);
     } else {
         printf("invalid option for table type\n");
         exit(7);
@@ -158,6 +294,10 @@ void RehashDriver(int test_M)
     table_t *H;
 
     printf("\n----- Rehash driver -----\n");
+    if (ProbeDec == SWISS || ProbeDec == CUCKOO) {
+        printf("  swiss and cuckoo tables place keys by hash buckets; use -r or -e\n");
+        return;
+    }
     hashkey_t startkey = LOWID + (test_M - LOWID%test_M);
     assert(startkey%test_M == 0);
     assert(test_M > 5);  // tests designed for size at least 6
@@ -222,10 +362,13 @@ void RehashDriver(int test_M)
     assert(table_entries(H) == test_M-2);
     assert(table_full(H) == 0);
     assert(table_peek(H,1) == PEEK_NOKEY);
-    assert(table_deletekeys(H) == 1);
+    // Robin Hood deletes leave no DELETEKEY and move keys back into place
+    if (ProbeDec != ROBINHOOD)
+        assert(table_deletekeys(H) == 1);
     ip = table_retrieve(H, startkey+1);  // check key is not there
     assert(ip == NULL);
-    assert(table_stats(H) >= 2);
+    // without a DELETEKEY to pass, Robin Hood stops at the empty slot
+    assert(table_stats(H) >= (ProbeDec == ROBINHOOD ? 1 : 2));
     // attempt to delete keys not in table 
     assert(NULL == table_delete(H, startkey+1));
     assert(NULL == table_delete(H, startkey+test_M-1));
@@ -291,8 +434,12 @@ void RehashDriver(int test_M)
     assert(0 == table_insert(H, startkey+20*test_M, ip));
     ip = NULL;
     assert(table_entries(H) == 5);
-    assert(table_peek(H,0) == startkey+20*test_M);
-    assert(table_deletekeys(H) == test_M-5);
+    if (ProbeDec != ROBINHOOD) {
+        assert(table_peek(H,0) == startkey+20*test_M);
+        assert(table_deletekeys(H) == test_M-5);
+    } else {
+        assert(table_deletekeys(H) == 0);
+    }
     // verify 5 items in table
     ip = table_retrieve(H, startkey+1+test_M);
     assert(*(int *)ip == 123);
@@ -409,7 +556,7 @@ void UnitDriver(int UnitInt)
     printf("Table:\n");
     table_t *test_table;
     if(UnitInt == 1){
-        test_table = table_construct(20, DOUBLE);
+        test_table = table_construct(20, DOUBLE | (TableOptions & TABLE_INLINE)); // build_table follows -V
         build_table(test_table, 10);
 
         printf("Table after inserts\n");
@@ -512,6 +659,59 @@ void UnitDriver(int UnitInt)
             printf("\ncould not find 16\n\n");
         }
     }
+    else if (UnitInt == 3){
+        int M = 131072, range = 2 * (int) (0.9 * M), k, i, w, rc, retrieves;
+        long probes;
+        double r;
+        uint64_t v;
+        // a table of 1 position has room for no key, so the first insert
+        // has to resize it
+        static const int probes1[] = {LINEAR, QUAD, ROBINHOOD, DOUBLE};
+        for (i = 0; i < 4; i++) {
+            test_table = table_construct(1, probes1[i] | TABLE_INLINE);
+            table_set_autoresize(test_table, 0.95, 0.25);
+            for (k = 0; k < 100; k++) {
+                rc = table_insert_value(test_table, k, k);
+                assert(rc == 0);
+            }
+            for (k = 0; k < 100; k++) {
+                rc = table_retrieve_value(test_table, k, &v);
+                assert(rc && v == (uint64_t) k);
+            }
+            table_destruct(test_table);
+        }
+        printf("tables of 1 position grow with autoresize\n");
+
+        // churn near max_load: the deleted positions must not take every
+        // empty one, so the probes of a retrieve stay bounded
+        test_table = table_construct(M, LINEAR | TABLE_POW2 | TABLE_INLINE);
+        table_set_autoresize(test_table, 0.95, 0.25);
+        srand48(Seed);
+        for (k = 0; k < range; k++)
+            if (drand48() < 0.5)
+                table_insert_value(test_table, k, k);
+        for (w = 1; w <= 20; w++) {
+            probes = retrieves = 0;
+            for (i = 0; i < 100000; i++) {
+                k = (int) (drand48() * range);
+                r = drand48();
+                if (r < 1.0 / 3) {
+                    rc = table_insert_value(test_table, k, k);
+                    assert(rc != -1);
+                } else if (r < 2.0 / 3)
+                    table_delete_value(test_table, k, &v);
+                else {
+                    table_retrieve_value(test_table, k, &v);
+                    probes += table_stats(test_table);
+                    retrieves++;
+                }
+            }
+            printf("after %7d calls: size %d, %d entries, %d deleted, %.1f probes per retrieve\n",
+                    w * 100000, table_size(test_table), table_entries(test_table),
+                    table_deletekeys(test_table), (double) probes / retrieves);
+            assert(probes < 100L * retrieves);
+        }
+    }
     /* remove and free all items from table */
     table_destruct(test_table);
     printf("----- End of unit driver -----\n\n");
@@ -527,14 +727,13 @@ void RetrieveDriver()
     int suc_search, suc_trials, unsuc_search, unsuc_trials;
     table_t *test_table;
     hashkey_t key;
-    data_t dp;
 
     /* print parameters for this test run */
     printf("\n----- Retrieve driver -----\n");
     printf("  Trials: %d\n", Trials);
 
-    num_keys = (int) (TableSize * LoadFactor);
-    test_table = table_construct(TableSize, ProbeDec);
+    test_table = table_construct(TableSize, ProbeDec | TableOptions);
+    num_keys = (int) (table_size(test_table) * LoadFactor);
 
     build_table(test_table, num_keys);
 
@@ -548,8 +747,7 @@ void RetrieveDriver()
             key = (hashkey_t) (drand48() * key_range) + MINID;
             if (Verbose)
                 printf("%d: looking for %d\n", i, key);
-            dp = table_retrieve(test_table, key);
-            if (dp == NULL) {
+            if (!find_key(test_table, key)) {
                 unsuc_search += table_stats(test_table);
                 unsuc_trials++;
                 if (Verbose)
@@ -562,7 +760,6 @@ void RetrieveDriver()
                 if (Verbose)
                     printf("\t\t FOUND with %d probes (this is rare!)\n", 
                             table_stats(test_table));
-                assert(*(int *)dp == key);
             }
         }
         assert(num_keys == table_entries(test_table));
@@ -576,10 +773,12 @@ void RetrieveDriver()
 
     /* print expected values from analysis with compare to experimental
      * measurements */
-    performanceFormulas(LoadFactor);
+    performanceFormulas(LoadFactor, table_size(test_table));
 
     /* remove and free all items from table */
     table_destruct(test_table);
+
+    hashCompare();
     printf("----- End of access driver -----\n\n");
 }
 
@@ -610,17 +809,17 @@ void RetrieveDriver()
  */
 void twoSum(const int* nums, const int numsSize, const int target, int *ans1, int *ans2)
 {
-    table_t *table = table_construct(find_first_prime(numsSize * 2), DOUBLE);
+    table_t *table = table_construct(find_first_prime(numsSize * 2), DOUBLE | TABLE_INLINE);
+    uint64_t place;
     for(int i = 0; i < numsSize; i++){
-        if(table_retrieve(table,target-nums[i]) != NULL){
+        if(table_retrieve_value(table, target-nums[i], &place)){
             *ans1 = i;
-            *ans2 = *(int*) table_retrieve(table,target-nums[i]);
+            *ans2 = (int) place; //index of the number that was stored earlier
             break;
         }
-        int *data_ptr = malloc(sizeof(int));
-        *data_ptr = i;
-        table_insert(table, nums[i], data_ptr);
+        table_insert_value(table, nums[i], i);
     }
+    table_destruct(table);
 }
 
 /* support function to generate arrays for Two Sums Problem
@@ -788,22 +987,21 @@ void equilibriumDriver(void)
 {
     int i, code;
     int key_range, num_keys;
-    int size;
+    int size, table_M;
     int ran_index;
     int suc_search, suc_trials, unsuc_search, unsuc_trials;
     int keys_added, keys_removed;
-    int *ip;
     table_t *test_table;
     hashkey_t key;
-    data_t dp;
     clock_t start, end;
 
     /* print parameters for this test run */
     printf("\n----- Equilibrium test driver -----\n");
     printf("  Trials: %d\n", Trials);
 
-    test_table = table_construct(TableSize, ProbeDec);
-    num_keys = (int) (TableSize * LoadFactor);
+    test_table = table_construct(TableSize, ProbeDec | TableOptions);
+    table_M = table_size(test_table);
+    num_keys = (int) (table_M * LoadFactor);
 
     /* build a table as starting point */
     build_table(test_table, num_keys);
@@ -818,11 +1016,9 @@ void equilibriumDriver(void)
         if (drand48() < 0.5 && table_full(test_table) == FALSE) {
             // insert only if table not full
             key = (hashkey_t) (drand48() * key_range) + MINID;
-            ip = (int *) malloc(sizeof(int));
-            *ip = key;
             /* insert returns 0 if key not found, 1 if older key found */
             if (Verbose) printf("Trial %d, Insert Key %d", i, key);
-            code = table_insert(test_table, key, ip);
+            code = insert_key(test_table, key);
             if (code == 0) {
                 /* key was not in table so added */
                 unsuc_search += table_stats(test_table);
@@ -837,12 +1033,12 @@ void equilibriumDriver(void)
                 printf("!!!Trial %d failed to insert key (%d) with code (%d)\n", i, key, code);
                 exit(10);
             }
-        } else if (table_entries(test_table) > TableSize/4) {
+        } else if (table_entries(test_table) > table_M/4) {
             // delete only if table is at least 25% full
             // why 25%?  Would 10% be better?  Lower than 10% will
             // be computationally expensive
             do {
-                ran_index = (int) (drand48() * TableSize);
+                ran_index = (int) (drand48() * table_M);
                 key = table_peek(test_table, ran_index);
             } while (key == PEEK_NOKEY);
             if (Verbose) printf("Trial %d, Delete Key %d", i, key);
@@ -851,14 +1047,11 @@ void equilibriumDriver(void)
                 printf("\n\n  table peek failed: invalid key (%d) during trial (%d)\n", key, i);
                 exit(12);
             }
-            dp = table_delete(test_table, key);
-            if (dp != NULL) {
+            if (remove_key(test_table, key)) {
                 if (Verbose) printf(" removed\n");
                 suc_search += table_stats(test_table);
                 suc_trials++;
                 keys_removed++;
-                assert(*(int *)dp == key);
-                free(dp);
             } else {
                 printf("!!! failed to find key (%d) in table, trial (%d)!\n", key, i);
                 printf("this is a catastrophic error!!!\n");
@@ -883,6 +1076,7 @@ void equilibriumDriver(void)
             (double) suc_search/suc_trials, suc_trials);
     printf("  unsuccessful searches during exercise=%g, trials=%d\n", 
             (double) unsuc_search/unsuc_trials, unsuc_trials);
+    printTableStats(test_table);
 
 
     /* test access times for new table */
@@ -890,42 +1084,37 @@ void equilibriumDriver(void)
     suc_search = suc_trials = unsuc_search = unsuc_trials = 0;
     start = clock();
     /* check each position in table for key */
-    for (i = 0; i < TableSize; i++) {
+    for (i = 0; i < table_M; i++) {
         key = table_peek(test_table, i);
         if (key != PEEK_NOKEY) {
             assert(MINID <= key && key <= MAXID);
-            dp = table_retrieve(test_table, key);
-            if (dp == NULL) {
+            if (!find_key(test_table, key)) {
                 printf("Failed to find key (%d) but it is in location (%d)\n", 
                         key, i);
                 exit(16);
             } else {
                 suc_search += table_stats(test_table);
                 suc_trials++;
-                assert(*(int *)dp == key);
             }
         }
     }
     for (i = 0; i < Trials; i++) {
         /* random key with uniform distribution */
         key = (hashkey_t) (drand48() * key_range) + MINID;
-        dp = table_retrieve(test_table, key);
-        if (dp == NULL) {
+        if (!find_key(test_table, key)) {
             unsuc_search += table_stats(test_table);
             unsuc_trials++;
-        } else {
-            // this should be very rare
-            assert(*(int *)dp == key);
         }
+        // else this should be very rare
     }
     end = clock();
     size = table_entries(test_table);
     printf("  After retrieve experiment, time=%g\n",
             1000*((double)(end-start))/CLOCKS_PER_SEC);
-    printf("  New load factor = %g\n", (double) size/TableSize);
+    printf("  New load factor = %g\n", (double) size/table_M);
     printf("  Percent empty locations marked deleted = %g\n",
             (double) 100.0 * table_deletekeys(test_table)
-            / (TableSize - table_entries(test_table)));
+            / (table_M - table_entries(test_table)));
 
     printf("   Measured avg probes for successful search=%g, trials=%d\n", 
             (double) suc_search/suc_trials, suc_trials);
@@ -933,11 +1122,11 @@ void equilibriumDriver(void)
     printf("   Measured avg probes for unsuccessful search=%g, trials=%d\n", 
             (double) unsuc_search/unsuc_trials, unsuc_trials);
     printf("    Do deletions increase avg number of probes?\n");
-    performanceFormulas((double) size/TableSize);
+    performanceFormulas((double) size/table_M, table_M);
 
     /* rehash and retest table */
     printf("  Rehash table\n");
-    test_table = table_rehash(test_table, TableSize);
+    test_table = table_rehash(test_table, table_M);
     /* number entries in table should not change */
     assert(size == table_entries(test_table));
     /* rehashing must clear all entries marked for deletion */
@@ -948,33 +1137,28 @@ void equilibriumDriver(void)
     suc_search = suc_trials = unsuc_search = unsuc_trials = 0;
     start = clock();
     /* check each position in table for key */
-    for (i = 0; i < TableSize; i++) {
+    for (i = 0; i < table_M; i++) {
         key = table_peek(test_table, i);
         if (key != PEEK_NOKEY) {
             assert(MINID <= key && key <= MAXID);
-            dp = table_retrieve(test_table, key);
-            if (dp == NULL) {
+            if (!find_key(test_table, key)) {
                 printf("Failed to find key (%d) after rehash but it is in location (%d)\n", 
                         key, i);
                 exit(26);
             } else {
                 suc_search += table_stats(test_table);
                 suc_trials++;
-                assert(*(int *)dp == key);
             }
         }
     }
     for (i = 0; i < Trials; i++) {
         /* random key with uniform distribution */
         key = (hashkey_t) (drand48() * key_range) + MINID;
-        dp = table_retrieve(test_table, key);
-        if (dp == NULL) {
+        if (!find_key(test_table, key)) {
             unsuc_search += table_stats(test_table);
             unsuc_trials++;
-        } else {
-            // this should be very rare
-            assert(*(int *)dp == key);
         }
+        // else this should be very rare
     }
     end = clock();
     size = table_entries(test_table);
@@ -992,6 +1176,59 @@ void equilibriumDriver(void)
     printf("----- End of equilibrium test -----\n\n");
 }
 
+/* the drivers store each key as its own information, behind a malloced int
+ * or with -V as an inline value.  insert_key returns the code of
+ * table_insert, and find_key and remove_key return TRUE if the key was in
+ * the table.
+ */
+int insert_key(table_t *T, hashkey_t key)
+{
+    int *ip, code;
+    if (TableOptions & TABLE_INLINE)
+        return table_insert_value(T, key, (uint64_t) (int64_t) key);
+    ip = (int *) malloc(sizeof(int));
+    *ip = key;
+    code = table_insert(T, key, ip);
+    if (code == -1)
+        free(ip);
+    return code;
+}
+
+int find_key(table_t *T, hashkey_t key)
+{
+    uint64_t value;
+    data_t dp;
+    if (TableOptions & TABLE_INLINE) {
+        if (!table_retrieve_value(T, key, &value))
+            return FALSE;
+        assert((hashkey_t) value == key);
+        return TRUE;
+    }
+    dp = table_retrieve(T, key);
+    if (dp == NULL)
+        return FALSE;
+    assert(*(int *)dp == key);
+    return TRUE;
+}
+
+int remove_key(table_t *T, hashkey_t key)
+{
+    uint64_t value;
+    data_t dp;
+    if (TableOptions & TABLE_INLINE) {
+        if (!table_delete_value(T, key, &value))
+            return FALSE;
+        assert((hashkey_t) value == key);
+        return TRUE;
+    }
+    dp = table_delete(T, key);
+    if (dp == NULL)
+        return FALSE;
+    assert(*(int *)dp == key);
+    free(dp);
+    return TRUE;
+}
+
 /* build a table with random keys.  The keys are generated with a uniform
  * distribution.  
  */
@@ -1000,14 +1237,11 @@ int build_random(table_t *T, int table_size, int num_addr)
     hashkey_t key;
     int i, range, code;
     int probes = 0;
-    int *ip;
     range = MAXID - MINID + 1;
     for (i = 0; i < num_addr; i++) {
         key = (hashkey_t) (drand48() * range) + MINID;
         assert(MINID <= key && key <= MAXID);
-        ip = (int *) malloc(sizeof(int));
-        *ip = key;
-        code = table_insert(T, key, ip);
+        code = insert_key(T, key);
         if (code == 1) {
             i--;   // since does not increase size of table
             // replaced.  The chances should be very small
@@ -1031,7 +1265,6 @@ int build_seq(table_t *T, int table_size, int num_addr)
 {
     hashkey_t key;
     int i, range, starting, code;
-    int *ip;
     int probes = 0;
     range = MAXID - MINID + 1;
     starting = (int) (drand48() * range) + MINID;
@@ -1040,9 +1273,7 @@ int build_seq(table_t *T, int table_size, int num_addr)
     for (i = starting; i < starting + num_addr; i++) {
         assert(MINID <= i && i <= MAXID);
         key = i;
-        ip = (int *) malloc(sizeof(int));
-        *ip = i;
-        code = table_insert(T, key, ip);
+        code = insert_key(T, key);
         if (code != 0) {
             printf("build of sequential table failed code (%d) index (%d) key (%d)\n",
                     code, i - starting, key);
@@ -1061,7 +1292,6 @@ int build_fold(table_t *T, int table_size, int num_addr)
 {
     int i, range, starting, code;
     int probes = 0;
-    int *ip;
     range = MAXID - MINID + 1;
     starting = (int) (drand48() * range) + MINID;
     if (starting <= MINID + table_size)
@@ -1070,9 +1300,7 @@ int build_fold(table_t *T, int table_size, int num_addr)
         starting -= table_size;
     for (i = starting; i > starting - num_addr/2; i--) {
         assert(MINID <= i && i <= MAXID);
-        ip = (int *) malloc(sizeof(int));
-        *ip = i;
-        code = table_insert(T, i, ip);
+        code = insert_key(T, i);
         if (code != 0) {
             printf("build of first phase of folded table failed code (%d) index (%d) key (%d)\n",
                     code, i - starting, i);
@@ -1082,9 +1310,7 @@ int build_fold(table_t *T, int table_size, int num_addr)
     }
     for (i = starting + table_size; i > starting + table_size - (num_addr+1)/2; i--) {
         assert(MINID <= i && i <= MAXID);
-        ip = (int *) malloc(sizeof(int));
-        *ip = i;
-        code = table_insert(T, i, ip);
+        code = insert_key(T, i);
         if (code != 0) {
             printf("build of second phase of folded table failed code (%d) index (%d) key (%d)\n",
                     code, i - starting, i);
@@ -1104,12 +1330,9 @@ int build_worst(table_t *T, int table_size, int num_addr)
     hashkey_t key = MAXID;
     int i, batches = 0, code;
     int probes = 0;
-    int *ip;
     for (i = 0; i < num_addr; i++) {
         assert(MINID <= key && key <= MAXID);
-        ip = (int *) malloc(sizeof(int));
-        *ip = key;
-        code = table_insert(T, key, ip);
+        code = insert_key(T, key);
         if (code != 0) {
             printf("build of worst table failed: code (%d) index (%d) key (%d) batch (%d)\n",
                     code, i, key, batches);
@@ -1154,17 +1377,963 @@ int find_first_prime(int number)
 }
 
 
+/* ----- hashCompare -----
+ *
+ * builds a table with the -i keys once with the abs(K) % M hash and once
+ * with the multiply-shift hash of TABLE_POW2, each with the entries in one
+ * array and with TABLE_SOA, and each at load factor -a, and
+ * measures the probes and the time per lookup for every key in the table
+ * (hits) and for -t random keys (almost all misses).  The multiply-shift
+ * table has -m rounded up to a power of two positions.  Both tables get
+ * the same keys, except that the seq, fold, and worst keys depend on the
+ * table size.
+ */
+static double wallNs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return 1e9*ts.tv_sec + ts.tv_nsec;
+}
+
+void hashCompare(void)
+{
+    static const struct { const char *name; int options; } schemes[] = {
+        {"abs(K) % M", 0},
+        {"abs(K) % M, soa", TABLE_SOA},
+        {"multiply-shift", TABLE_POW2},
+        {"multiply-shift, soa", TABLE_POW2 | TABLE_SOA},
+    };
+    int nschemes = sizeof(schemes)/sizeof(schemes[0]);
+    int s, i, j, M, n, misses, found;
+    long hit_probes, miss_probes;
+    double hit_ns, miss_ns, start;
+    hashkey_t key, *keys, *randkeys;
+    table_t *T;
+
+    printf("  Compare hashing schemes, load factor %g\n", LoadFactor);
+    printf("  %-20s %10s %12s %10s %12s %10s\n", "hash", "size",
+            "hit probes", "hit ns", "miss probes", "miss ns");
+    for (s = 0; s < nschemes; s++) {
+        T = table_construct(TableSize, ProbeDec | schemes[s].options | (TableOptions & TABLE_INLINE));
+        M = table_size(T);
+        n = (int) (M * LoadFactor);
+        srand48(Seed);
+        if (TableType == RAND)
+            build_random(T, M, n);
+        else if (TableType == SEQ)
+            build_seq(T, M, n);
+        else if (TableType == FOLD)
+            build_fold(T, M, n);
+        else
+            build_worst(T, M, n);
+
+        // look the keys up in random order so the walk through the table
+        // does not help the cache
+        keys = (hashkey_t *) malloc(n * sizeof(hashkey_t));
+        for (i = j = 0; i < M; i++)
+            if ((key = table_peek(T, i)) != PEEK_NOKEY)
+                keys[j++] = key;
+        assert(j <= n);
+        n = j;   // keys in the cuckoo stash have no index to peek at
+        for (i = n - 1; i > 0; i--) {
+            j = (int) (drand48() * (i + 1));
+            key = keys[i]; keys[i] = keys[j]; keys[j] = key;
+        }
+        hit_probes = 0;
+        start = wallNs();
+        for (i = 0; i < n; i++) {
+            found = find_key(T, keys[i]);
+            assert(found);
+            hit_probes += table_stats(T);
+        }
+        hit_ns = (wallNs() - start) / n;
+
+        randkeys = (hashkey_t *) malloc(Trials * sizeof(hashkey_t));
+        for (i = 0; i < Trials; i++)
+            randkeys[i] = (hashkey_t) (drand48() * (MAXID - MINID + 1)) + MINID;
+        miss_probes = misses = 0;
+        start = wallNs();
+        for (i = 0; i < Trials; i++) {
+            if (!find_key(T, randkeys[i])) {
+                miss_probes += table_stats(T);
+                misses++;
+            }
+        }
+        miss_ns = (wallNs() - start) / Trials;
+        free(randkeys);
+        printf("  %-20s %10d %12g %10.1f %12g %10.1f\n", schemes[s].name, M,
+                (double) hit_probes/n, hit_ns,
+                misses > 0 ? (double) miss_probes/misses : 0.0, miss_ns);
+        free(keys);
+        table_destruct(T);
+    }
+}
+
+/* ----- loadSweep -----
+ *
+ * for each load factor builds one table of each probe type with the same
+ * random keys, and measures the time per lookup of every key in the table
+ * (hits, in random order), per lookup of -t random keys (misses), and per
+ * delete and insert pair for -t pairs that keep the load factor steady.
+ * The last column is the percent of empty slots marked deleted after the
+ * pairs.
+ */
+void loadSweep(void)
+{
+    static const double loads[] = {0.5, 0.6, 0.7, 0.8, 0.85, 0.9, 0.95};
+    static const struct { const char *name; int probe; } types[] = {
+        {"linear", LINEAR},
+        {"double", DOUBLE},
+        {"robinhood", ROBINHOOD},
+        {"swiss", SWISS},
+        {"cuckoo", CUCKOO},
+    };
+    int nloads = sizeof(loads)/sizeof(loads[0]);
+    int ntypes = sizeof(types)/sizeof(types[0]);
+    int l, t, i, j, M, n, code, found;
+    double hit_ns, miss_ns, churn_ns, start;
+    hashkey_t key, *keys, *randkeys, *newkeys;
+    int *slots;
+    table_t *T;
+
+    printf("\n----- Load sweep driver -----\n");
+    printf("  Trials: %d\n", Trials);
+    printf("  %6s %-10s %8s %10s %10s %10s %10s\n", "load", "probe", "size",
+            "hit ns", "miss ns", "churn ns", "% deleted");
+    randkeys = (hashkey_t *) malloc(Trials * sizeof(hashkey_t));
+    newkeys = (hashkey_t *) malloc(Trials * sizeof(hashkey_t));
+    slots = (int *) malloc(Trials * sizeof(int));
+    for (l = 0; l < nloads; l++) {
+        for (t = 0; t < ntypes; t++) {
+            T = table_construct(TableSize, types[t].probe | TableOptions);
+            M = table_size(T);
+            n = (int) (M * loads[l]);
+            // like build_random, but without a message for each of the
+            // few hundred duplicate keys a table of a million gets
+            srand48(Seed);
+            keys = (hashkey_t *) malloc(n * sizeof(hashkey_t));
+            for (i = 0; i < n; ) {
+                key = (hashkey_t) (drand48() * (MAXID - MINID + 1)) + MINID;
+                code = insert_key(T, key);
+                assert(code != -1);
+                if (code == 0)
+                    keys[i++] = key;
+            }
+            for (i = n - 1; i > 0; i--) {
+                j = (int) (drand48() * (i + 1));
+                key = keys[i]; keys[i] = keys[j]; keys[j] = key;
+            }
+            for (i = 0; i < Trials; i++) {
+                randkeys[i] = (hashkey_t) (drand48() * (MAXID - MINID + 1)) + MINID;
+                newkeys[i] = (hashkey_t) (drand48() * (MAXID - MINID + 1)) + MINID;
+                slots[i] = (int) (drand48() * n);
+            }
+
+            start = wallNs();
+            for (i = 0; i < n; i++) {
+                found = find_key(T, keys[i]);
+                assert(found);
+            }
+            hit_ns = (wallNs() - start) / n;
+
+            start = wallNs();
+            for (i = 0; i < Trials; i++)
+                find_key(T, randkeys[i]);
+            miss_ns = (wallNs() - start) / Trials;
+
+            // keys[] keeps track of what is in the table.  A duplicate new
+            // key leaves a key in keys[] twice, and its second delete
+            // finds nothing
+            start = wallNs();
+            for (i = 0; i < Trials; i++) {
+                j = slots[i];
+                remove_key(T, keys[j]);
+                insert_key(T, newkeys[i]);
+                keys[j] = newkeys[i];
+            }
+            churn_ns = (wallNs() - start) / Trials;
+
+            printf("  %6g %-10s %8d %10.1f %10.1f %10.1f %10.1f\n", loads[l],
+                    types[t].name, M, hit_ns, miss_ns, churn_ns,
+                    100.0 * table_deletekeys(T) / (M - table_entries(T)));
+            free(keys);
+            table_destruct(T);
+        }
+    }
+    free(randkeys);
+    free(newkeys);
+    free(slots);
+    printf("----- End of load sweep -----\n\n");
+}
+
+/* ----- cuckooDriver -----
+ *
+ * the keys for each table are the same: random ones, or for -i worst the
+ * keys MAXID, MAXID - m, MAXID - 2m, and so on, which all have the same
+ * abs(K) % m.  Misses are -t random keys.  The last step measures the
+ * load factor cuckoo reaches, which depends on the kicks and stash of
+ * table.c and not on -a.
+ */
+void cuckooDriver(void)
+{
+    static const struct { const char *name; int probe; } types[] = {
+        {"linear", LINEAR},
+        {"robinhood", ROBINHOOD},
+        {"swiss", SWISS},
+        {"cuckoo", CUCKOO},
+    };
+    int ntypes = sizeof(types)/sizeof(types[0]);
+    int t, i, M, n, code, found, per, max_hit, max_miss;
+    long hit_probes, miss_probes;
+    double insert_ns, hit_ns, miss_ns, start;
+    hashkey_t key, *keys, *randkeys;
+    table_t *T;
+
+    printf("\n----- Cuckoo driver -----\n");
+    printf("  Trials: %d, %s keys\n", Trials, TableType == WORST ? "worst" : "random");
+    if (TableType != RAND && TableType != WORST) {
+        printf("  use -i rand or -i worst\n");
+        return;
+    }
+    printf("  %-10s %8s %10s %10s %12s %10s %12s\n", "probe", "size",
+            "insert ns", "hit ns", "hit probes", "miss ns", "miss probes");
+    randkeys = (hashkey_t *) malloc(Trials * sizeof(hashkey_t));
+    srand48(Seed + 1);   // not the sequence of the keys in the tables
+    for (i = 0; i < Trials; i++)
+        randkeys[i] = (hashkey_t) (drand48() * (MAXID - MINID + 1)) + MINID;
+    per = (MAXID - MINID) / TableSize;   // worst keys before the next batch
+    for (t = 0; t < ntypes; t++) {
+        T = table_construct(TableSize, types[t].probe | TableOptions);
+        M = table_size(T);
+        n = (int) (M * LoadFactor);
+        keys = (hashkey_t *) malloc(n * sizeof(hashkey_t));
+        srand48(Seed);
+        for (i = 0; i < n; i++) {
+            if (TableType == WORST)
+                keys[i] = MAXID - (i % per) * TableSize - i / per;
+            else
+                keys[i] = (hashkey_t) (drand48() * (MAXID - MINID + 1)) + MINID;
+        }
+
+        start = wallNs();
+        for (i = 0; i < n; i++) {
+            code = insert_key(T, keys[i]);
+            if (code == -1) {
+                printf("  %-10s insert failed at load factor %g, use a smaller -a\n",
+                        types[t].name, (double) table_entries(T)/M);
+                exit(7);
+            }
+        }
+        insert_ns = (wallNs() - start) / n;
+
+        hit_probes = max_hit = 0;
+        start = wallNs();
+        for (i = 0; i < n; i++) {
+            found = find_key(T, keys[i]);
+            assert(found);
+            hit_probes += table_stats(T);
+            if (table_stats(T) > max_hit)
+                max_hit = table_stats(T);
+        }
+        hit_ns = (wallNs() - start) / n;
+
+        miss_probes = max_miss = 0;
+        start = wallNs();
+        for (i = 0; i < Trials; i++) {
+            find_key(T, randkeys[i]);
+            miss_probes += table_stats(T);
+            if (table_stats(T) > max_miss)
+                max_miss = table_stats(T);
+        }
+        miss_ns = (wallNs() - start) / Trials;
+
+        printf("  %-10s %8d %10.1f %10.1f %6.2f/%-5d %10.1f %6.2f/%-5d\n",
+                types[t].name, M, insert_ns, hit_ns, (double) hit_probes/n, max_hit,
+                miss_ns, (double) miss_probes/Trials, max_miss);
+
+        if (types[t].probe == CUCKOO) {
+            // keep adding random keys until the kicks and the stash run out
+            n = table_entries(T);
+            start = wallNs();
+            do {
+                key = (hashkey_t) (drand48() * (MAXID - MINID + 1)) + MINID;
+                code = insert_key(T, key);
+            } while (code != -1);
+            n = table_entries(T) - n;
+            printf("  cuckoo first failed insert at load factor %g, %.1f ns per insert above %g\n",
+                    (double) table_entries(T)/M, n > 0 ? (wallNs() - start) / n : 0.0, LoadFactor);
+        }
+        free(keys);
+        table_destruct(T);
+    }
+    free(randkeys);
+    printf("----- End of cuckoo driver -----\n\n");
+}
+
+/* ----- growthDriver -----
+ *
+ * times every insert of the same -t random keys into a growing table, so
+ * the one insert that pays for a rehash shows up in the largest times
+ * instead of disappearing into the average.
+ */
+static int compareDouble(const void *a, const void *b)
+{
+    double x = *(const double *) a, y = *(const double *) b;
+    return (x > y) - (x < y);
+}
+
+void growthDriver(void)
+{
+    static const char *names[] = {"automatic", "table_rehash"};
+    int s, i, code, new_M;
+    double start, total, *ns;
+    hashkey_t *keys;
+    table_t *T;
+
+    printf("\n----- Growth driver -----\n");
+    printf("  Trials: %d, starting size %d, max load factor %g\n", Trials, TableSize, LoadFactor);
+    printf("  %-14s %10s %10s %10s %10s %12s\n", "resize", "final size",
+            "avg ns", "99% ns", "99.9% ns", "max ns");
+    keys = (hashkey_t *) malloc(Trials * sizeof(hashkey_t));
+    ns = (double *) malloc(Trials * sizeof(double));
+    srand48(Seed);
+    for (i = 0; i < Trials; i++)
+        keys[i] = (hashkey_t) (drand48() * (MAXID - MINID + 1)) + MINID;
+    for (s = 0; s < 2; s++) {
+        T = table_construct(TableSize, ProbeDec | TableOptions);
+        if (s == 0)
+            table_set_autoresize(T, LoadFactor, 0.25);
+        total = 0;
+        for (i = 0; i < Trials; i++) {
+            start = wallNs();
+            if (s == 1 && table_entries(T) + 1 > LoadFactor * table_size(T)) {
+                new_M = 2 * table_size(T);
+                if (ProbeDec == DOUBLE && !(TableOptions & TABLE_POW2))
+                    new_M = find_first_prime(new_M);
+                T = table_rehash(T, new_M);
+            }
+            code = insert_key(T, keys[i]);
+            ns[i] = wallNs() - start;
+            total += ns[i];
+            if (code == -1) {
+                printf("  %s: insert %d failed at size %d\n", names[s], i, table_size(T));
+                exit(8);
+            }
+        }
+        qsort(ns, Trials, sizeof(double), compareDouble);
+        printf("  %-14s %10d %10.1f %10.1f %10.1f %12.1f\n", names[s], table_size(T),
+                total / Trials, ns[(int) (0.99 * (Trials - 1))],
+                ns[(int) (0.999 * (Trials - 1))], ns[Trials - 1]);
+        table_destruct(T);
+    }
+    free(keys);
+    free(ns);
+    printf("----- End of growth driver -----\n\n");
+}
+
+/* ----- batchDriver -----
+ *
+ * every row builds its own table from the same keys in the same order, so
+ * the tables are the same and only the calls differ.  The data for the
+ * inserts is malloced before the clock starts.  Batch 0 is one
+ * table_insert or table_retrieve per key.
+ */
+void batchDriver(void)
+{
+    static const int batches[] = {0, 1, 8, 32, 128};
+    int nbatches = sizeof(batches)/sizeof(batches[0]);
+    int b, i, n, M, size, found;
+    double insert_ns, hit_ns, miss_ns, start;
+    hashkey_t *keys, *hitkeys, *randkeys;
+    data_t *data, *out;
+    table_t *T;
+
+    printf("\n----- Batch driver -----\n");
+    printf("  Trials: %d\n", Trials);
+    printf("  %-8s %10s %10s %10s %10s\n", "batch", "size", "insert ns",
+            "hit ns", "miss ns");
+    // the driver keeps data pointers, so -V does not apply
+    T = table_construct(TableSize, ProbeDec | (TableOptions & ~TABLE_INLINE));
+    M = table_size(T);
+    table_destruct(T);
+    n = (int) (M * LoadFactor);
+    keys = (hashkey_t *) malloc(n * sizeof(hashkey_t));
+    data = (data_t *) malloc(n * sizeof(data_t));
+    hitkeys = (hashkey_t *) malloc(Trials * sizeof(hashkey_t));
+    randkeys = (hashkey_t *) malloc(Trials * sizeof(hashkey_t));
+    out = (data_t *) malloc(128 * sizeof(data_t));
+    srand48(Seed);
+    for (i = 0; i < n; i++)
+        keys[i] = (hashkey_t) (drand48() * (MAXID - MINID + 1)) + MINID;
+    for (i = 0; i < Trials; i++) {
+        hitkeys[i] = keys[(int) (drand48() * n)];
+        randkeys[i] = (hashkey_t) (drand48() * (MAXID - MINID + 1)) + MINID;
+    }
+    for (b = 0; b < nbatches; b++) {
+        T = table_construct(TableSize, ProbeDec | (TableOptions & ~TABLE_INLINE));
+        for (i = 0; i < n; i++) {
+            data[i] = malloc(sizeof(int));
+            *(int *)data[i] = keys[i];
+        }
+        start = wallNs();
+        if (batches[b] == 0) {
+            for (i = 0; i < n; i++)
+                if (table_insert(T, keys[i], data[i]) == -1)
+                    break;
+        } else {
+            for (i = 0; i < n; i += size) {
+                size = n - i < batches[b] ? n - i : batches[b];
+                table_insert_batch(T, keys + i, data + i, size, NULL);
+            }
+        }
+        insert_ns = (wallNs() - start) / n;
+        // duplicate keys replace each other, so there are a few less
+        if (table_entries(T) < n - n/100) {
+            printf("  insert failed at load factor %g, use a smaller -a\n",
+                    (double) table_entries(T)/M);
+            exit(9);
+        }
+
+        found = 0;
+        start = wallNs();
+        if (batches[b] == 0) {
+            for (i = 0; i < Trials; i++)
+                if (table_retrieve(T, hitkeys[i]) != NULL)
+                    found++;
+        } else {
+            for (i = 0; i < Trials; i += size) {
+                size = Trials - i < batches[b] ? Trials - i : batches[b];
+                found += table_retrieve_batch(T, hitkeys + i, size, out);
+            }
+        }
+        hit_ns = (wallNs() - start) / Trials;
+        assert(found == Trials);
+
+        start = wallNs();
+        if (batches[b] == 0) {
+            for (i = 0; i < Trials; i++)
+                table_retrieve(T, randkeys[i]);
+        } else {
+            for (i = 0; i < Trials; i += size) {
+                size = Trials - i < batches[b] ? Trials - i : batches[b];
+                table_retrieve_batch(T, randkeys + i, size, out);
+            }
+        }
+        miss_ns = (wallNs() - start) / Trials;
+
+        if (batches[b] == 0)
+            printf("  %-8s %10d %10.1f %10.1f %10.1f\n", "none", M,
+                    insert_ns, hit_ns, miss_ns);
+        else
+            printf("  %-8d %10d %10.1f %10.1f %10.1f\n", batches[b], M,
+                    insert_ns, hit_ns, miss_ns);
+        table_destruct(T);
+    }
+    free(keys);
+    free(data);
+    free(hitkeys);
+    free(randkeys);
+    free(out);
+    printf("----- End of batch driver -----\n\n");
+}
+
+/* ----- concurrentDriver -----
+ *
+ * key k of the range has the data_ptr k + 1, which is never NULL, so every
+ * I that comes back can be checked without a malloc for each key.  Every
+ * run starts from a new table with the same keys, and ends by checking
+ * that ctable_entries agrees with a search for every key of the range.
+ */
+typedef struct {
+    ctable_t *T;
+    int id;
+    int range;
+    int calls;
+    double reads;       // fraction of calls that are ctable_retrieve
+    long probes;
+    int compactions;
+} concurrent_arg_t;
+
+#define CONCURRENT_DATA(k) ((data_t) (uintptr_t) ((k) + 1))
+
+static void *concurrentWorker(void *arg)
+{
+    concurrent_arg_t *a = (concurrent_arg_t *) arg;
+    unsigned short xsubi[3] = {(unsigned short) Seed, (unsigned short) a->id, 0x330E};
+    data_t dp, old;
+    double r;
+    int i, k;
+
+    a->probes = 0;
+    a->compactions = 0;
+    for (i = 0; i < a->calls; i++) {
+        k = (int) (erand48(xsubi) * a->range);
+        r = erand48(xsubi);
+        if (r < a->reads) {
+            dp = ctable_retrieve(a->T, k);
+            assert(dp == NULL || dp == CONCURRENT_DATA(k));
+        } else if (r < a->reads + (1.0 - a->reads) / 2) {
+            old = NULL;
+            if (ctable_insert(a->T, k, CONCURRENT_DATA(k), &old) == 1)
+                assert(old == CONCURRENT_DATA(k));
+        } else {
+            dp = ctable_delete(a->T, k);
+            assert(dp == NULL || dp == CONCURRENT_DATA(k));
+        }
+        a->probes += ctable_stats();
+        if (i % 1024 == 0
+                && 2 * ctable_deletekeys(a->T) > ctable_size(a->T) - ctable_entries(a->T)) {
+            ctable_compact(a->T);
+            a->compactions++;
+        }
+    }
+    return NULL;
+}
+
+void concurrentDriver(int max)
+{
+    static const struct { const char *name; double reads; } mixes[] = {
+        {"90/5/5", 0.9},
+        {"50/25/25", 0.5},
+        {"10/45/45", 0.1},
+    };
+    int nmixes = sizeof(mixes)/sizeof(mixes[0]);
+    int m, n, t, k, range, found, compactions;
+    long probes;
+    double start, ns;
+    pthread_t *threads;
+    concurrent_arg_t *args;
+    ctable_t *T;
+
+    printf("\n----- Concurrent equilibrium driver -----\n");
+    T = ctable_construct(TableSize);
+    range = 2 * (int) (ctable_size(T) * LoadFactor);
+    printf("  Trials: %d, size %d, keys 0 to %d\n", Trials, ctable_size(T), range - 1);
+    ctable_destruct(T);
+    printf("  %-20s %8s %10s %10s %10s %10s\n", "retrieve/insert/del", "threads",
+            "Mops/s", "probes", "compacts", "% deleted");
+    threads = (pthread_t *) malloc(max * sizeof(pthread_t));
+    args = (concurrent_arg_t *) malloc(max * sizeof(concurrent_arg_t));
+    for (m = 0; m < nmixes; m++) {
+        // 1, 2, 4, ... and always max last
+        for (n = 1; n <= max; n = (n < max && 2 * n > max) ? max : 2 * n) {
+            T = ctable_construct(TableSize);
+            srand48(Seed);
+            for (k = 0; k < range; k++)
+                if (drand48() < 0.5)
+                    ctable_insert(T, k, CONCURRENT_DATA(k), NULL);
+
+            start = wallNs();
+            for (t = 0; t < n; t++) {
+                args[t].T = T;
+                args[t].id = t;
+                args[t].range = range;
+                args[t].calls = Trials / n + (t < Trials % n);
+                args[t].reads = mixes[m].reads;
+                pthread_create(&threads[t], NULL, concurrentWorker, &args[t]);
+            }
+            for (t = 0; t < n; t++)
+                pthread_join(threads[t], NULL);
+            ns = wallNs() - start;
+
+            probes = 0;
+            compactions = 0;
+            for (t = 0; t < n; t++) {
+                probes += args[t].probes;
+                compactions += args[t].compactions;
+            }
+            found = 0;
+            for (k = 0; k < range; k++)
+                if (ctable_retrieve(T, k) != NULL)
+                    found++;
+            assert(found == ctable_entries(T));
+            printf("  %-20s %8d %10.2f %10.2f %10d %10.1f\n", mixes[m].name, n,
+                    1000.0 * Trials / ns, (double) probes / Trials, compactions,
+                    100.0 * ctable_deletekeys(T) / (ctable_size(T) - ctable_entries(T)));
+            ctable_destruct(T);
+        }
+    }
+    free(threads);
+    free(args);
+    printf("----- End of concurrent equilibrium driver -----\n\n");
+}
+
+/* ----- shardedDriver -----
+ *
+ * the k-th key of the range is keys[k], with the value k + 1.  The keys
+ * are distinct since keys[k] % range is k.  The table_t is T behind lock,
+ * and each thread adds up table_stats while it still holds the lock; the
+ * shards keep their own counts.
+ */
+typedef struct {
+    table_sharded_t *S;     // NULL for the single table
+    table_t *T;
+    pthread_mutex_t *lock;
+    int id;
+    int range;
+    int *keys;
+    int calls;
+    double reads;           // fraction of calls that are retrieves
+    long probes;
+} sharded_arg_t;
+
+#define SHARDED_SHARDS 64
+
+static void *shardedWorker(void *arg)
+{
+    sharded_arg_t *a = (sharded_arg_t *) arg;
+    unsigned short xsubi[3] = {(unsigned short) Seed, (unsigned short) a->id, 0x330E};
+    uint64_t v;
+    double r;
+    int i, k, op, rc;
+    hashkey_t K;
+
+    a->probes = 0;
+    for (i = 0; i < a->calls; i++) {
+        k = (int) (erand48(xsubi) * a->range);
+        K = a->keys[k];
+        r = erand48(xsubi);
+        op = r < a->reads ? 0 : r < a->reads + (1.0 - a->reads) / 2 ? 1 : 2;
+        if (a->S != NULL) {
+            if (op == 0 && table_sharded_retrieve_value(a->S, K, &v))
+                assert(v == (uint64_t) k + 1);
+            else if (op == 1) {
+                rc = table_sharded_insert_value(a->S, K, (uint64_t) k + 1);
+                assert(rc != -1);
+            }
+            else if (op == 2 && table_sharded_delete_value(a->S, K, &v))
+                assert(v == (uint64_t) k + 1);
+            continue;
+        }
+        pthread_mutex_lock(a->lock);
+        if (op == 0 && table_retrieve_value(a->T, K, &v))
+            assert(v == (uint64_t) k + 1);
+        else if (op == 1) {
+            rc = table_insert_value(a->T, K, (uint64_t) k + 1);
+            assert(rc != -1);
+        }
+        else if (op == 2 && table_delete_value(a->T, K, &v))
+            assert(v == (uint64_t) k + 1);
+        a->probes += table_stats(a->T);
+        pthread_mutex_unlock(a->lock);
+    }
+    return NULL;
+}
+
+/* the calls and probes of all the shards so far */
+static void shardedTotals(table_sharded_t *S, long *calls, long *probes)
+{
+    long c, p;
+    int i;
+
+    *calls = *probes = 0;
+    for (i = 0; i < table_sharded_shards(S); i++) {
+        table_sharded_stats(S, i, &c, &p);
+        *calls += c;
+        *probes += p;
+    }
+}
+
+void shardedDriver(int max)
+{
+    static const struct { const char *name; double reads; } mixes[] = {
+        {"90/5/5", 0.9},
+        {"50/25/25", 0.5},
+        {"10/45/45", 0.1},
+    };
+    static const char *names[] = {"one lock", "sharded"};
+    int nmixes = sizeof(mixes)/sizeof(mixes[0]);
+    int m, s, n, t, k, range, most, found, rc, *keys;
+    long calls0, probes0, calls, probes;
+    double start, ns;
+    uint64_t v;
+    pthread_t *threads;
+    sharded_arg_t *args;
+    pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+    table_sharded_t *S;
+    table_t *T;
+
+    printf("\n----- Sharded driver -----\n");
+    range = 2 * (int) (TableSize * LoadFactor);
+    printf("  Trials: %d, size %d, %d shards, keys 0 to %d\n", Trials, TableSize,
+            SHARDED_SHARDS, range - 1);
+    keys = (int *) malloc(range * sizeof(int));
+    srand48(Seed);
+    for (k = 0; k < range; k++)
+        keys[k] = k + range * (int) (lrand48() % (MAXID / range));
+    printf("  %-10s %-20s %8s %10s %10s %10s\n", "table", "retrieve/insert/del",
+            "threads", "Mops/s", "probes", "max shard");
+    threads = (pthread_t *) malloc(max * sizeof(pthread_t));
+    args = (sharded_arg_t *) malloc(max * sizeof(sharded_arg_t));
+    for (m = 0; m < nmixes; m++) {
+        for (s = 0; s < 2; s++) {
+            // 1, 2, 4, ... and always max last
+            for (n = 1; n <= max; n = (n < max && 2 * n > max) ? max : 2 * n) {
+                S = NULL;
+                T = NULL;
+                if (s == 0) {
+                    T = table_construct(TableSize, ProbeDec | TableOptions | TABLE_INLINE);
+                    table_set_autoresize(T, 0.95, 0.25);
+                } else {
+                    S = table_sharded_construct(SHARDED_SHARDS, TableSize,
+                            ProbeDec | TableOptions | TABLE_INLINE);
+                    table_sharded_set_autoresize(S, 0.95, 0.25);
+                }
+                srand48(Seed);
+                for (k = 0; k < range; k++)
+                    if (drand48() < 0.5) {
+                        if (S != NULL)
+                            rc = table_sharded_insert_value(S, keys[k], (uint64_t) k + 1);
+                        else
+                            rc = table_insert_value(T, keys[k], (uint64_t) k + 1);
+                        assert(rc != -1);
+                    }
+                calls0 = probes0 = 0;
+                if (S != NULL)
+                    shardedTotals(S, &calls0, &probes0);
+
+                start = wallNs();
+                for (t = 0; t < n; t++) {
+                    args[t].S = S;
+                    args[t].T = T;
+                    args[t].lock = &lock;
+                    args[t].id = t;
+                    args[t].range = range;
+                    args[t].keys = keys;
+                    args[t].calls = Trials / n + (t < Trials % n);
+                    args[t].reads = mixes[m].reads;
+                    pthread_create(&threads[t], NULL, shardedWorker, &args[t]);
+                }
+                for (t = 0; t < n; t++)
+                    pthread_join(threads[t], NULL);
+                ns = wallNs() - start;
+
+                probes = 0;
+                most = 0;
+                if (S != NULL) {
+                    shardedTotals(S, &calls, &probes);
+                    assert(calls - calls0 == Trials);
+                    probes -= probes0;
+                    for (t = 0; t < SHARDED_SHARDS; t++)
+                        if (table_sharded_shard_entries(S, t) > most)
+                            most = table_sharded_shard_entries(S, t);
+                } else {
+                    for (t = 0; t < n; t++)
+                        probes += args[t].probes;
+                }
+                found = 0;
+                for (k = 0; k < range; k++)
+                    if (S != NULL ? table_sharded_retrieve_value(S, keys[k], &v)
+                                  : table_retrieve_value(T, keys[k], &v))
+                        found++;
+                if (S != NULL) {
+                    assert(found == table_sharded_entries(S));
+                    printf("  %-10s %-20s %8d %10.2f %10.2f %10.2f\n", names[s], mixes[m].name,
+                            n, 1000.0 * Trials / ns, (double) probes / Trials,
+                            (double) most * SHARDED_SHARDS / found);
+                    table_sharded_destruct(S);
+                } else {
+                    assert(found == table_entries(T));
+                    printf("  %-10s %-20s %8d %10.2f %10.2f\n", names[s], mixes[m].name,
+                            n, 1000.0 * Trials / ns, (double) probes / Trials);
+                    table_destruct(T);
+                }
+            }
+        }
+    }
+    free(threads);
+    free(args);
+    free(keys);
+    printf("----- End of sharded driver -----\n\n");
+}
+
+/* ----- compactDriver -----
+ *
+ * every method builds the same table in a child process with the same
+ * seed, and the child writes one compact_result_t back through a pipe
+ */
+typedef struct {
+    double deleted;     // % of the empty positions marked deleted
+    double pause_ms;
+    double peak_mb;
+    double miss_probes;
+    double miss_ns;
+} compact_result_t;
+
+static void compactRun(int method, compact_result_t *r)
+{
+    table_t *T;
+    hashkey_t key;
+    struct rusage usage;
+    double start, ns;
+    int i, M, found, misses;
+    long probes;
+
+    T = table_construct(TableSize, ProbeDec | TableOptions);
+    M = table_size(T);
+    build_table(T, (int) (M * LoadFactor));
+    if (method == 3)
+        table_set_autocompact(T, (1.0 - LoadFactor) / 2);
+    r->pause_ms = 0.0;
+    for (i = 0; i < Trials; i++) {
+        if (drand48() < 0.5 && table_full(T) == FALSE) {
+            key = (hashkey_t) (drand48() * (MAXID - MINID + 1)) + MINID;
+            start = wallNs();
+            insert_key(T, key);
+        } else if (table_entries(T) > M/4) {
+            do {
+                key = table_peek(T, (int) (drand48() * M));
+            } while (key == PEEK_NOKEY);
+            start = wallNs();
+            if (!remove_key(T, key)) {
+                printf("!!! failed to find key (%d) in table, trial (%d)!\n", key, i);
+                exit(11);
+            }
+        } else {
+            continue;
+        }
+        ns = wallNs() - start;
+        if (ns / 1e6 > r->pause_ms)
+            r->pause_ms = ns / 1e6;
+    }
+    if (method == 1 || method == 2) {
+        start = wallNs();
+        if (method == 1)
+            T = table_rehash(T, M);
+        else
+            table_compact(T);
+        r->pause_ms = (wallNs() - start) / 1e6;
+    }
+    r->deleted = 100.0 * table_deletekeys(T) / (table_size(T) - table_entries(T));
+
+    // every key is still where a search finds it
+    found = 0;
+    for (i = 0; i < table_size(T); i++)
+        if ((key = table_peek(T, i)) != PEEK_NOKEY) {
+            assert(find_key(T, key));
+            found++;
+        }
+    assert(found == table_entries(T));
+
+    probes = misses = 0;
+    start = wallNs();
+    for (i = 0; i < Trials; i++) {
+        key = (hashkey_t) (drand48() * (MAXID - MINID + 1)) + MINID;
+        if (!find_key(T, key)) {
+            probes += table_stats(T);
+            misses++;
+        }
+    }
+    r->miss_ns = (wallNs() - start) / Trials;
+    r->miss_probes = misses > 0 ? (double) probes / misses : 0.0;
+    getrusage(RUSAGE_SELF, &usage);
+    r->peak_mb = usage.ru_maxrss / 1024.0;    // in kilobytes on Linux
+    table_destruct(T);
+}
+
+void compactDriver(void)
+{
+    static const char *names[] = {"nothing", "table_rehash", "table_compact", "autocompact"};
+    compact_result_t r;
+    int method, fds[2];
+    ssize_t n;
+    pid_t pid;
+
+    printf("\n----- Compact driver -----\n");
+    printf("  Trials: %d\n", Trials);
+    printf("  %-16s %10s %10s %10s %12s %10s\n", "method", "% deleted", "pause ms",
+            "peak MB", "miss probes", "miss ns");
+    for (method = 0; method < 4; method++) {
+        if (pipe(fds) != 0) {
+            printf("!!! no pipe for the %s run\n", names[method]);
+            exit(13);
+        }
+        fflush(stdout);    // or the child prints the rows so far again
+        pid = fork();
+        assert(pid >= 0);
+        if (pid == 0) {
+            close(fds[0]);
+            srand48(Seed);
+            compactRun(method, &r);
+            n = write(fds[1], &r, sizeof(r));
+            fflush(stdout);
+            _exit(n == sizeof(r) ? 0 : 1);   // the parent reports a short write
+        }
+        close(fds[1]);
+        if (read(fds[0], &r, sizeof(r)) != sizeof(r)) {
+            printf("!!! the %s run failed\n", names[method]);
+            exit(13);
+        }
+        close(fds[0]);
+        waitpid(pid, NULL, 0);
+        printf("  %-16s %10.1f %10.2f %10.1f %12.2f %10.1f\n", names[method], r.deleted,
+                r.pause_ms, r.peak_mb, r.miss_probes, r.miss_ns);
+    }
+    printf("----- End of compact driver -----\n\n");
+}
+
+/* the percentile p of a histogram with n counts, as the first bin that
+ * gets there.  A bin past TABLE_STATS_EXACT holds a range of lengths, so
+ * it is written as ">=" its least length.
+ */
+static char *statsPercentile(char *buf, const long *hist, long n, int p)
+{
+    long sum = 0;
+    int b;
+
+    for (b = 0; b < TABLE_STATS_BINS - 1; b++) {
+        sum += hist[b];
+        if (100 * sum >= p * n)
+            break;
+    }
+    if (b < TABLE_STATS_EXACT)
+        sprintf(buf, "%d", b);
+    else
+        sprintf(buf, ">=%d", table_stats_bin_min(b));
+    return buf;
+}
+
+/* print what table_get_stats has for T */
+void printTableStats(table_t *T)
+{
+    static const char *ops[] = {"insert", "delete", "retrieve"};
+    struct table_stats S;
+    char p50[16], p99[16];
+    int op;
+
+    if (table_get_stats(T, &S)) {
+        printf("  %-10s %10s %8s %8s %8s %8s\n", "probes", "calls", "mean", "50%", "99%", "max");
+        for (op = 0; op < TABLE_OPS; op++) {
+            if (S.calls[op] == 0)
+                continue;
+            printf("  %-10s %10ld %8.2f %8s %8s %8d\n", ops[op], S.calls[op],
+                    (double) S.probes[op] / S.calls[op],
+                    statsPercentile(p50, S.probe_hist[op], S.calls[op], 50),
+                    statsPercentile(p99, S.probe_hist[op], S.calls[op], 99), S.max_probes[op]);
+        }
+    }
+    printf("  clusters of full or deleted positions=%d, mean length=%g, 50%% at %s, 99%% at %s, longest=%d\n",
+            S.clusters, S.clusters > 0 ? (table_entries(T) + table_deletekeys(T)) / (double) S.clusters : 0.0,
+            statsPercentile(p50, S.cluster_hist, S.clusters, 50),
+            statsPercentile(p99, S.cluster_hist, S.clusters, 99), S.max_cluster);
+    printf("  positions without a key that are marked deleted=%.1f%%\n", 100.0 * S.tombstone_density);
+}
+
 /* print performance evaulation formulas from Standish pg. 479 and pg 484
  *
  * Added additional formulas for linear probing and sequential, folded, and
- * worst addressing.  Also, for quadratic with worst addressing since it
+ * worst addressing with the abs(K) % M hash.  Also, for quadratic with worst addressing since it
  * behaves the same as linear in this case.  Formulas for the other cases
- * are unknown.
+ * are unknown, and that includes swiss, which is linear probing with
+ * buckets of 16 slots.  Cuckoo has no probe sequence: a search reads at
+ * most two buckets and the stash.
  */
-void performanceFormulas(double load_factor)
+void performanceFormulas(double load_factor, int table_M)
 {
-    int n = TableSize * load_factor;
-    if (TableType == RAND) {
+    int n = table_M * load_factor;
+    // the multiply-shift hash spreads sequential, folded, and worst keys
+    // like random ones
+    if (TableType == RAND || (TableOptions & TABLE_POW2)) {
         if (ProbeDec == LINEAR) {
             printf("--- Linear probe sequence performance formulas ---\n");
             printf("    Expected probes for successful search %g\n",
@@ -1186,6 +2355,18 @@ void performanceFormulas(double load_factor)
             printf("    Expected probes for unsuccessful search %g\n",
                     1.0/(1.0 - load_factor) - load_factor - log(1.0 - load_factor));
         }
+        else if (ProbeDec == ROBINHOOD) {
+            // the same slots are full as with linear probing, so a hit
+            // costs the same on average.  A miss at home h stops after the
+            // keys that hash to h (alpha on average) and the keys from
+            // before h that spill past it (alpha times the mean distance
+            // from home, alpha/(2(1-alpha)), on average)
+            printf("--- Robin Hood probe sequence performance formulas ---\n");
+            printf("    Expected probes for successful search %g\n",
+                    0.5 * (1.0 + 1.0/(1.0 - load_factor)));
+            printf("    Expected probes for unsuccessful search %g\n",
+                    1.0 + load_factor + load_factor * load_factor / (2.0 * (1.0 - load_factor)));
+        }
     }
     else if (TableType == SEQ) {
         if (ProbeDec == LINEAR) {
@@ -1233,7 +2414,7 @@ void getCommandLine(int argc, char **argv)
     int c;
     int index;
 
-    while ((c = getopt(argc, argv, "m:a:h:i:t:s:p:erbvu:")) != -1)
+    while ((c = getopt(argc, argv, "m:a:h:i:t:s:p:erbvu:PSVLkgBC:N:D")) != -1)
         switch(c) {
             case 'm': TableSize = atoi(optarg);      break;
             case 'a': LoadFactor = atof(optarg);     break;
@@ -1245,6 +2426,16 @@ void getCommandLine(int argc, char **argv)
             case 'b': RehashTest = TRUE;             break;
             case 'p': TwoSumTest = atoi(optarg);     break;
             case 'u': UnitInt = atoi(optarg);     break;
+            case 'P': TableOptions |= TABLE_POW2;    break;
+            case 'S': TableOptions |= TABLE_SOA;     break;
+            case 'V': TableOptions |= TABLE_INLINE;  break;
+            case 'L': LoadSweep = TRUE;              break;
+            case 'k': CuckooTest = TRUE;             break;
+            case 'g': GrowthTest = TRUE;             break;
+            case 'B': BatchTest = TRUE;              break;
+            case 'C': ConcurrentThreads = atoi(optarg); break;
+            case 'N': ShardedThreads = atoi(optarg); break;
+            case 'D': CompactTest = TRUE;            break;
             case 'h':
                       if (strcmp(optarg, "linear") == 0)
                           ProbeDec = LINEAR;
@@ -1252,9 +2443,15 @@ void getCommandLine(int argc, char **argv)
                           ProbeDec = DOUBLE;
                       else if (strcmp(optarg, "quad") == 0)
                           ProbeDec = QUAD;
+                      else if (strcmp(optarg, "robinhood") == 0)
+                          ProbeDec = ROBINHOOD;
+                      else if (strcmp(optarg, "swiss") == 0)
+                          ProbeDec = SWISS;
+                      else if (strcmp(optarg, "cuckoo") == 0)
+                          ProbeDec = CUCKOO;
                       else {
                           fprintf(stderr, "invalid type of probing decrement: %s\n", optarg);
-                          fprintf(stderr, "must be {linear | double | quad}\n");
+                          fprintf(stderr, "must be {linear | double | quad | robinhood | swiss | cuckoo}\n");
                           exit(1);
                       }
                       break;
@@ -1283,13 +2480,23 @@ void getCommandLine(int argc, char **argv)
                       printf("General options ---------\n");
                       printf("  -m 11     table size\n");
                       printf("  -a 0.9    load factor\n");
-                      printf("  -h linear|double|quad\n");
+                      printf("  -h linear|double|quad|robinhood|swiss|cuckoo\n");
                       printf("            Type of probing decrement\n");
+                      printf("  -P        power-of-two size with multiply-shift hash\n");
+                      printf("  -S        keys and data pointers in separate arrays\n");
+                      printf("  -V        inline values instead of malloced data\n");
                       printf("  -r        run retrieve test driver \n");
                       printf("  -b        run basic test driver \n");
                       printf("  -p x      run Two Sums Problem driver for x=1,2,3, or 4\n");
                       printf("                 use -m array size -t test trials\n");
                       printf("  -e        run equilibrium test driver\n");
+                      printf("  -L        run load factor sweep of all probe types\n");
+                      printf("  -k        run cuckoo driver, use -i rand|worst\n");
+                      printf("  -g        run growth driver, automatic vs manual resizing\n");
+                      printf("  -B        run batch driver, use a table bigger than the cache\n");
+                      printf("  -C 4      run concurrent equilibrium driver with up to 4 threads\n");
+                      printf("  -N 4      run sharded driver with up to 4 threads\n");
+                      printf("  -D        run compact driver, use -V to leave out the mallocs per key\n");
                       printf("  -i rand|seq|fold|worst\n");
                       printf("            type of keys for retrieve test driver \n");
                       printf("\nOptions for drivers ---------\n");
@@ -0,0 +1,170 @@
+/* shtable.c
+ * Hash Table Implementation
+ * Fall 2022
+ *
+ * Propose: A front end that splits the keys over shards of table_t, each
+ * with its own lock.  See shtable.h.
+ */
+
+#include <stdlib.h>
+#include <assert.h>
+#include <stdint.h>
+#include "table.h"
+#include "shtable.h"
+#define SHARD_MULT 0xFF51AFD7ED558CCDULL   // used by no probe type of table.c
+#define SHARD_MIN_SIZE 16                  // a SWISS group, or 4 CUCKOO buckets
+
+table_sharded_t *table_sharded_construct(int nshards, int table_size, int probe_type){
+    int bits = 0;
+    while((1 << bits) < nshards){ //rounds nshards up to a power of two
+        bits++;
+    }
+    assert(bits <= 16);
+    table_sharded_t *S = malloc(sizeof(table_sharded_t));
+    assert(S != NULL);
+    S->nshards = 1 << bits;
+    S->shard_bits = bits;
+    S->shards = aligned_alloc(_Alignof(table_shard_t), sizeof(table_shard_t) * S->nshards);
+    assert(S->shards != NULL);
+    int shard_size = (table_size + S->nshards - 1) / S->nshards;
+    if(shard_size < SHARD_MIN_SIZE){ //a table of 1 or 2 positions holds next to no keys
+        shard_size = SHARD_MIN_SIZE;
+    }
+    for(int i = 0; i < S->nshards; i++){
+        pthread_mutex_init(&S->shards[i].lock, NULL);
+        S->shards[i].T = table_construct(shard_size, probe_type);
+        S->shards[i].calls = 0;
+        S->shards[i].probes = 0;
+    }
+    return S;
+}
+
+void table_sharded_destruct(table_sharded_t *S){
+    for(int i = 0; i < S->nshards; i++){
+        table_destruct(S->shards[i].T);
+        pthread_mutex_destroy(&S->shards[i].lock);
+    }
+    free(S->shards);
+    free(S);
+}
+
+int table_sharded_shards(table_sharded_t *S){
+    return S->nshards;
+}
+
+int table_sharded_shard(table_sharded_t *S, hashkey_t K){
+    if(S->shard_bits == 0){
+        return 0; //a shift by 64 is undefined
+    }
+    return (int) (((uint64_t) (uint32_t) K * SHARD_MULT) >> (64 - S->shard_bits));
+}
+
+/* locks the shard of K and returns it */
+static inline table_shard_t *shard_lock(table_sharded_t *S, hashkey_t K){
+    table_shard_t *shard = &S->shards[table_sharded_shard(S, K)];
+    pthread_mutex_lock(&shard->lock);
+    return shard;
+}
+
+/* counts the call that was just made on the shard and unlocks it */
+static inline void shard_unlock(table_shard_t *shard){
+    shard->calls++;
+    shard->probes += table_stats(shard->T);
+    pthread_mutex_unlock(&shard->lock);
+}
+
+void table_sharded_set_autoresize(table_sharded_t *S, double max_load, double max_deleted){
+    for(int i = 0; i < S->nshards; i++){
+        pthread_mutex_lock(&S->shards[i].lock);
+        table_set_autoresize(S->shards[i].T, max_load, max_deleted);
+        pthread_mutex_unlock(&S->shards[i].lock);
+    }
+}
+
+void table_sharded_rehash(table_sharded_t *S, int shard, int new_table_size){
+    assert(0 <= shard && shard < S->nshards);
+    pthread_mutex_lock(&S->shards[shard].lock);
+    S->shards[shard].T = table_rehash(S->shards[shard].T, new_table_size);
+    pthread_mutex_unlock(&S->shards[shard].lock);
+}
+
+int table_sharded_insert(table_sharded_t *S, hashkey_t K, data_t I){
+    table_shard_t *shard = shard_lock(S, K);
+    int code = table_insert(shard->T, K, I);
+    shard_unlock(shard);
+    return code;
+}
+
+data_t table_sharded_delete(table_sharded_t *S, hashkey_t K){
+    table_shard_t *shard = shard_lock(S, K);
+    data_t I = table_delete(shard->T, K);
+    shard_unlock(shard);
+    return I;
+}
+
+data_t table_sharded_retrieve(table_sharded_t *S, hashkey_t K){
+    table_shard_t *shard = shard_lock(S, K);
+    data_t I = table_retrieve(shard->T, K);
+    shard_unlock(shard);
+    return I;
+}
+
+int table_sharded_insert_value(table_sharded_t *S, hashkey_t K, uint64_t V){
+    table_shard_t *shard = shard_lock(S, K);
+    int code = table_insert_value(shard->T, K, V);
+    shard_unlock(shard);
+    return code;
+}
+
+int table_sharded_delete_value(table_sharded_t *S, hashkey_t K, uint64_t *V){
+    table_shard_t *shard = shard_lock(S, K);
+    int found = table_delete_value(shard->T, K, V);
+    shard_unlock(shard);
+    return found;
+}
+
+int table_sharded_retrieve_value(table_sharded_t *S, hashkey_t K, uint64_t *V){
+    table_shard_t *shard = shard_lock(S, K);
+    int found = table_retrieve_value(shard->T, K, V);
+    shard_unlock(shard);
+    return found;
+}
+
+/* adds up one of the table_ counts over the shards, each under its lock */
+static int sharded_sum(table_sharded_t *S, int (*count)(table_t *)){
+    int sum = 0;
+    for(int i = 0; i < S->nshards; i++){
+        pthread_mutex_lock(&S->shards[i].lock);
+        sum += count(S->shards[i].T);
+        pthread_mutex_unlock(&S->shards[i].lock);
+    }
+    return sum;
+}
+
+int table_sharded_entries(table_sharded_t *S){
+    return sharded_sum(S, table_entries);
+}
+
+int table_sharded_deletekeys(table_sharded_t *S){
+    return sharded_sum(S, table_deletekeys);
+}
+
+int table_sharded_size(table_sharded_t *S){
+    return sharded_sum(S, table_size);
+}
+
+int table_sharded_shard_entries(table_sharded_t *S, int shard){
+    assert(0 <= shard && shard < S->nshards);
+    pthread_mutex_lock(&S->shards[shard].lock);
+    int entries = table_entries(S->shards[shard].T);
+    pthread_mutex_unlock(&S->shards[shard].lock);
+    return entries;
+}
+
+void table_sharded_stats(table_sharded_t *S, int shard, long *calls, long *probes){
+    assert(0 <= shard && shard < S->nshards);
+    pthread_mutex_lock(&S->shards[shard].lock);
+    *calls = S->shards[shard].calls;
+    *probes = S->shards[shard].probes;
+    pthread_mutex_unlock(&S->shards[shard].lock);
+}
@@ -0,0 +1,90 @@
+/* shtable.h
+ * Hash Table Implementation
+ * Fall 2022
+ *
+ * Public functions for a sharded hash table that threads can share
+ *
+ * A table_sharded_t is a front end for nshards independent table_t's.
+ * The top bits of a multiply-shift hash of K pick the shard, and every
+ * call locks the mutex of that shard only, so threads working on keys of
+ * different shards do not wait for each other.  The hash that routes a key
+ * uses a multiplier of its own, not the HASH_MULT of TABLE_POW2, SWISS,
+ * and the first CUCKOO bucket, nor the HASH_MULT2 of the second CUCKOO
+ * bucket, so within a shard the keys are still spread over every bucket
+ * of its table.
+ *
+ * Each shard is one table_t with everything that comes with it: the probe
+ * type and TABLE_ options passed to table_sharded_construct, automatic
+ * resizing, and ownership of the data.  A resize or rehash only holds the
+ * lock of one shard, so it pauses 1/nshards of the keys.  Each shard sits
+ * on its own cache lines with its lock and its own call and probe counts.
+ *
+ * The I returned by table_sharded_retrieve belongs to the table, so it is
+ * only safe to use while no other thread can delete or replace K.  With
+ * TABLE_INLINE the _value functions copy the value out under the lock.
+ *
+ * Include table.h first.
+ */
+
+#include <pthread.h>
+
+typedef struct table_shard_tag {
+    // private members for shtable.c only
+    _Alignas(64) pthread_mutex_t lock;
+    table_t *T;
+    long calls;                 // calls made on this shard
+    long probes;                // table_stats summed over those calls
+} table_shard_t;
+
+typedef struct table_sharded_tag {
+    // private members for shtable.c only
+    table_shard_t *shards;
+    int nshards;                // a power of two
+    int shard_bits;
+} table_sharded_t;
+
+/* allocates nshards empty tables with table_construct(table_size /
+ * nshards, probe_type), but of at least 16 positions each.  nshards is
+ * rounded up to a power of two.
+ */
+table_sharded_t *table_sharded_construct(int nshards, int table_size, int probe_type);
+
+/* frees every shard and its data.  No other thread may be using the
+ * table.
+ */
+void table_sharded_destruct(table_sharded_t *S);
+
+/* table_set_autoresize for every shard */
+void table_sharded_set_autoresize(table_sharded_t *S, double max_load, double max_deleted);
+
+/* table_rehash of shard number shard only, while the other shards stay
+ * in use
+ */
+void table_sharded_rehash(table_sharded_t *S, int shard, int new_table_size);
+
+/* the same as table_insert, table_delete, table_retrieve, and their
+ * _value versions, for the shard of K
+ */
+int table_sharded_insert(table_sharded_t *S, hashkey_t K, data_t I);
+data_t table_sharded_delete(table_sharded_t *S, hashkey_t K);
+data_t table_sharded_retrieve(table_sharded_t *S, hashkey_t K);
+int table_sharded_insert_value(table_sharded_t *S, hashkey_t K, uint64_t V);
+int table_sharded_delete_value(table_sharded_t *S, hashkey_t K, uint64_t *V);
+int table_sharded_retrieve_value(table_sharded_t *S, hashkey_t K, uint64_t *V);
+
+/* the number of shards, and the shard that K is routed to */
+int table_sharded_shards(table_sharded_t *S);
+int table_sharded_shard(table_sharded_t *S, hashkey_t K);
+
+/* the sums of table_entries, table_deletekeys, and table_size over the
+ * shards.  While other threads insert or delete they are only a snapshot.
+ */
+int table_sharded_entries(table_sharded_t *S);
+int table_sharded_deletekeys(table_sharded_t *S);
+int table_sharded_size(table_sharded_t *S);
+
+/* the entries of one shard, and the calls made on it and the probes they
+ * took since table_sharded_construct
+ */
+int table_sharded_shard_entries(table_sharded_t *S, int shard);
+void table_sharded_stats(table_sharded_t *S, int shard, long *calls, long *probes);
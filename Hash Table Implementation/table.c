@@ -10,11 +10,95 @@
 #include <stdlib.h>
 #include <assert.h>
 #include <limits.h>
+#include <stdint.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#ifdef __unix__
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
 #include "table.h"
 #define EMPTYKEY 1000000001
 #define DELETEKEY 1000000002
+#define SWISS_GROUP 16      // slots per group of control bytes
+#define SWISS_EMPTY 0x80
+#define SWISS_DELETED 0xFE
+#define CUCKOO_SLOTS 4      // slots per bucket, 4 entries of 16 bytes are one cache line
+#define CUCKOO_STASH 8
+#define CUCKOO_KICKS 500    // keys moved by one insert before it uses the stash
+#define MIGRATE_SLOTS 16    // old slots moved by each insert or delete while resizing
+#define PREPARE_SLOTS 64    // slots of the next arrays filled by each insert or delete
+#define RETIRE_PAGES 16     // pages of moved-out arrays given back by each insert or delete
+#define BATCH_AHEAD 16      // keys of a batch prefetched ahead of the one being looked up
+
+/* the key and the data_ptr of slot i.  Without TABLE_SOA they are the two
+ * fields of T->oa[i], and with it they are element i of a keys array and
+ * of a data_ptr array, so each layout is just a base and a stride.
+ */
+#define KEY(T, i) (*(hashkey_t *) ((T)->key_base + (size_t) (i) * (T)->key_stride))
+#define DATA(T, i) (*(data_t *) ((T)->val_base + (size_t) (i) * (T)->val_stride))
+
+static inline table_entry_t entry_get(table_t *T, int i){
+    table_entry_t entry = {KEY(T, i), DATA(T, i)};
+    return entry;
+}
+
+static inline void entry_set(table_t *T, int i, table_entry_t entry){
+    KEY(T, i) = entry.key;
+    DATA(T, i) = entry.data_ptr;
+}
+
+/* frees the I of a replaced or destructed entry.  With TABLE_INLINE the
+ * data_ptr holds a value and the table owns nothing.
+ */
+static inline void data_free(table_t *T, data_t I){
+    if(!(T->table_options & TABLE_INLINE)){
+        free(I);
+    }
+}
+
+/* adds the call that just ended to T->counts.  Without TABLE_STATS it is
+ * nothing at all, not even a test of T->counts
+ */
+#ifdef TABLE_STATS
+static void stats_count(table_t *T, int op){
+    int probes = T->num_probes_for_most_recent_call;
+    if(T->counts == NULL){
+        return; //the new table of a table_rehash
+    }
+    T->counts->calls[op]++;
+    T->counts->probes[op] += probes;
+    T->counts->probe_hist[op][table_stats_bin(probes)]++;
+    if(probes > T->counts->max_probes[op]){
+        T->counts->max_probes[op] = probes;
+    }
+}
+#else
+#define stats_count(T, op) ((void) 0)
+#endif
+
+/* 2^64 divided by the golden ratio.  Multiplying by it and keeping the top
+ * bits is Knuth's multiplicative hashing; consecutive keys land about 0.618
+ * of the table apart.
+ */
+#define HASH_MULT 0x9E3779B97F4A7C15ULL
+
+static inline uint64_t hash_mix(hashkey_t K){
+    return (uint64_t) (uint32_t) K * HASH_MULT;
+}
+
+/* a second, independent multiplier for the other CUCKOO bucket */
+#define HASH_MULT2 0xC2B2AE3D27D4EB4FULL
+
+static inline uint64_t hash_mix2(hashkey_t K){
+    return (uint64_t) (uint32_t) K * HASH_MULT2;
+}
 
 int H(hashkey_t K, table_t *T){ //CREATED HASH FUNCTION
+    if(T->table_options & TABLE_POW2){
+        return (int) (hash_mix(K) >> (64 - T->hash_bits)); //top bits of the product
+    }
     int hashval = abs(K) % T->table_size_M; //given hash function
     return hashval;
 }
@@ -23,6 +107,11 @@ int P(hashkey_t K, table_t *T){ //CREATED PROBE DECREMENT FUNCTION
     if(T->type_of_probing_used_for_this_table == LINEAR){ //linear probing
         return 1;
     }
+    else if(T->type_of_probing_used_for_this_table == DOUBLE && (T->table_options & TABLE_POW2)){
+        // the hash_bits below the ones H used, made odd so the decrement
+        // and the power-of-two size have no common factor
+        return (int) ((hash_mix(K) << T->hash_bits) >> (64 - T->hash_bits)) | 1;
+    }
     else if(T->type_of_probing_used_for_this_table == DOUBLE){ //double probing
         int len = sizeof(K); //uses given equation
         unsigned char *p = (unsigned char *) &K;
@@ -43,39 +132,663 @@ int P(hashkey_t K, table_t *T){ //CREATED PROBE DECREMENT FUNCTION
     return 1;
 }
 
-table_t *table_construct(int table_size, int probe_type){
-    table_t *table = malloc(sizeof(table_t)); //mallocs table
-    table->oa = malloc(sizeof(table_entry_t) * table_size); //mallocs oa
+/* moves index back by probedec and wraps it around the table */
+static inline int probe_next(table_t *T, int index, int probedec){
+    if(T->table_options & TABLE_POW2){
+        return (int) ((unsigned) (index - probedec) & (unsigned) (T->table_size_M - 1));
+    }
+    index -= probedec; //decrements
+    if(index < 0){
+        index += T->table_size_M; //loops around the table
+    }
+    return index;
+}
+
+/* ----- Robin Hood probing -----
+ *
+ * probes go down from the home position like LINEAR, so the distance of
+ * the key in slot index from its home is H(key) - index, wrapped around
+ */
+static inline int rh_dist(table_t *T, hashkey_t key, int index){
+    int dist = H(key,T) - index;
+    return dist < 0 ? dist + T->table_size_M : dist;
+}
+
+/* returns the slot of K, or -1 if K is not in the table */
+static int rh_find(table_t *T, hashkey_t K){
+    int index = H(K,T);
+    T->num_probes_for_most_recent_call = 0;
+    for(int dist = 0; dist < T->table_size_M; dist++){
+        T->num_probes_for_most_recent_call++;
+        hashkey_t key = KEY(T, index);
+        if(key == K){
+            return index;
+        }
+        if(key == EMPTYKEY || rh_dist(T, key, index) < dist){
+            return -1; //K would have taken this slot
+        }
+        index = probe_next(T, index, 1);
+    }
+    return -1;
+}
+
+static int rh_insert(table_t *T, hashkey_t K, data_t I){
+    int index = H(K,T);
+    int dist;
+    T->num_probes_for_most_recent_call = 0;
+    for(dist = 0; dist < T->table_size_M; dist++){ //finds K or the slot K belongs in
+        T->num_probes_for_most_recent_call++;
+        hashkey_t key = KEY(T, index);
+        if(key == K){
+            data_free(T, DATA(T, index));
+            DATA(T, index) = I;
+            return 1;
+        }
+        if(key == EMPTYKEY || rh_dist(T, key, index) < dist){
+            break;
+        }
+        index = probe_next(T, index, 1);
+    }
+    if(table_full(T) == 1){
+        return -1;
+    }
+    // the run below index is ordered by home, so K goes here and the rest
+    // of the run moves down one slot into the next empty one
+    table_entry_t carry = {K, I};
+    while(KEY(T, index) != EMPTYKEY){
+        table_entry_t next = entry_get(T, index);
+        entry_set(T, index, carry);
+        carry = next;
+        index = probe_next(T, index, 1);
+    }
+    entry_set(T, index, carry);
+    T->num_keys_stored_in_table++;
+    return 0;
+}
+
+static int rh_delete(table_t *T, hashkey_t K, data_t *I){
+    int index = rh_find(T, K);
+    if(index == -1){
+        return 0;
+    }
+    *I = DATA(T, index);
+    // backward shift: move the keys after index up one slot until a key
+    // that is already at home or an empty slot ends the run
+    int next = probe_next(T, index, 1);
+    while(KEY(T, next) != EMPTYKEY && rh_dist(T, KEY(T, next), next) > 0){
+        entry_set(T, index, entry_get(T, next));
+        index = next;
+        next = probe_next(T, next, 1);
+    }
+    KEY(T, index) = EMPTYKEY;
+    DATA(T, index) = NULL;
+    T->num_keys_stored_in_table--;
+    return 1;
+}
+
+/* ----- Swiss table -----
+ *
+ * the 64-bit hash of K is split in two: the top 32 bits pick the home
+ * group with a multiply instead of a modulo (Lemire's fastrange), and 7
+ * bits from the low half go in the control byte.  A search scans whole
+ * groups going down from the home group and stops at the first group that
+ * has an empty slot.  A group that fills up never gets an empty slot back
+ * (a delete only writes SWISS_EMPTY into a group that still has one), so
+ * no key can be stored past a group with an empty slot.
+ */
+static inline int swiss_group(table_t *T, uint64_t h){
+    return (int) (((h >> 32) * (uint64_t) (T->table_size_M / SWISS_GROUP)) >> 32);
+}
+
+static inline unsigned char swiss_h2(uint64_t h){
+    return (unsigned char) ((h >> 25) & 0x7f);
+}
+
+#ifdef __SSE2__
+/* returns a bit for each control byte of the group that equals c */
+static inline unsigned swiss_match(const unsigned char *group, unsigned char c){
+    __m128i ctrl = _mm_load_si128((const __m128i *) group);
+    return (unsigned) _mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8((char) c)));
+}
+
+/* returns a bit for each empty or deleted slot of the group */
+static inline unsigned swiss_match_free(const unsigned char *group){
+    return (unsigned) _mm_movemask_epi8(_mm_load_si128((const __m128i *) group));
+}
+#else
+static inline unsigned swiss_match(const unsigned char *group, unsigned char c){
+    unsigned mask = 0;
+    for(int i = 0; i < SWISS_GROUP; i++){
+        mask |= (unsigned) (group[i] == c) << i;
+    }
+    return mask;
+}
+
+static inline unsigned swiss_match_free(const unsigned char *group){
+    unsigned mask = 0;
+    for(int i = 0; i < SWISS_GROUP; i++){
+        mask |= (unsigned) (group[i] >> 7) << i; //only empty and deleted have the high bit
+    }
+    return mask;
+}
+#endif
+
+/* looks for K and returns its slot or -1.  If free_slot is not NULL it is
+ * set to the first empty or deleted slot seen, or -1
+ */
+static int swiss_find(table_t *T, hashkey_t K, int *free_slot){
+    uint64_t h = hash_mix(K);
+    unsigned char h2 = swiss_h2(h);
+    int groups = T->table_size_M / SWISS_GROUP;
+    int g = swiss_group(T, h);
+    unsigned m;
+
+    T->num_probes_for_most_recent_call = 0;
+    if(free_slot != NULL){
+        *free_slot = -1;
+    }
+    for(int n = 0; n < groups; n++){
+        const unsigned char *ctrl = T->ctrl + g * SWISS_GROUP;
+        T->num_probes_for_most_recent_call++;
+        for(m = swiss_match(ctrl, h2); m != 0; m &= m - 1){ //only read entries whose byte matches
+            int index = g * SWISS_GROUP + __builtin_ctz(m);
+            T->num_probes_for_most_recent_call++;
+            if(KEY(T, index) == K){
+                return index;
+            }
+        }
+        if(free_slot != NULL && *free_slot == -1 && (m = swiss_match_free(ctrl)) != 0){
+            *free_slot = g * SWISS_GROUP + __builtin_ctz(m);
+        }
+        if(swiss_match(ctrl, SWISS_EMPTY) != 0){
+            return -1; //K would have been put in this group
+        }
+        g = (g == 0) ? groups - 1 : g - 1;
+    }
+    return -1;
+}
+
+static int swiss_insert(table_t *T, hashkey_t K, data_t I){
+    int slot;
+    int index = swiss_find(T, K, &slot);
+    if(index != -1){
+        data_free(T, DATA(T, index));
+        DATA(T, index) = I;
+        return 1;
+    }
+    if(table_full(T) == 1){
+        return -1;
+    }
+    assert(slot != -1); //fewer than M-1 keys means a free slot was seen
+    if(T->ctrl[slot] == SWISS_DELETED){
+        T->deletedkeys--;
+    }
+    T->ctrl[slot] = swiss_h2(hash_mix(K));
+    KEY(T, slot) = K;
+    DATA(T, slot) = I;
+    T->num_keys_stored_in_table++;
+    return 0;
+}
+
+static int swiss_delete(table_t *T, hashkey_t K, data_t *I){
+    int index = swiss_find(T, K, NULL);
+    if(index == -1){
+        return 0;
+    }
+    *I = DATA(T, index);
+    // searches only go past full groups, so a group that still has an
+    // empty slot can take another one
+    if(swiss_match(T->ctrl + (index & ~(SWISS_GROUP - 1)), SWISS_EMPTY) != 0){
+        T->ctrl[index] = SWISS_EMPTY;
+        KEY(T, index) = EMPTYKEY;
+    }
+    else{
+        T->ctrl[index] = SWISS_DELETED;
+        KEY(T, index) = DELETEKEY;
+        T->deletedkeys++;
+    }
+    DATA(T, index) = NULL;
+    T->num_keys_stored_in_table--;
+    return 1;
+}
+
+/* ----- cuckoo hashing -----
+ *
+ * bucket b is slots b*4 to b*4+3.  Both buckets of a key come from the
+ * top 32 bits of a hash with the multiply of fastrange, and if they are
+ * the same the second is the next bucket up, so every key has two.
+ */
+static inline void cuckoo_buckets(table_t *T, hashkey_t K, int *b1, int *b2){
+    uint64_t buckets = (uint64_t) (T->table_size_M / CUCKOO_SLOTS);
+    *b1 = (int) (((hash_mix(K) >> 32) * buckets) >> 32);
+    *b2 = (int) (((hash_mix2(K) >> 32) * buckets) >> 32);
+    if(*b2 == *b1){
+        *b2 = (*b1 + 1) % (int) buckets;
+    }
+}
+
+/* returns the first empty slot of bucket b, or -1 */
+static inline int cuckoo_free_slot(table_t *T, int b){
+    for(int i = b * CUCKOO_SLOTS; i < (b + 1) * CUCKOO_SLOTS; i++){
+        if(KEY(T, i) == EMPTYKEY){
+            return i;
+        }
+    }
+    return -1;
+}
+
+/* returns the slot of K, table_size_M + i for stash entry i, or -1 */
+static int cuckoo_find(table_t *T, hashkey_t K){
+    int b1, b2;
+    cuckoo_buckets(T, K, &b1, &b2);
+    T->num_probes_for_most_recent_call = 1;
+    for(int i = b1 * CUCKOO_SLOTS; i < (b1 + 1) * CUCKOO_SLOTS; i++){
+        if(KEY(T, i) == K){
+            return i;
+        }
+    }
+    T->num_probes_for_most_recent_call++;
+    for(int i = b2 * CUCKOO_SLOTS; i < (b2 + 1) * CUCKOO_SLOTS; i++){
+        if(KEY(T, i) == K){
+            return i;
+        }
+    }
+    if(T->stash_used > 0){
+        T->num_probes_for_most_recent_call++;
+        for(int i = 0; i < T->stash_used; i++){
+            if(T->stash[i].key == K){
+                return T->table_size_M + i;
+            }
+        }
+    }
+    return -1;
+}
+
+/* xorshift, only used to pick which key of a full bucket to move.  One
+ * per thread, so threads that each lock their own table_t (shtable.c) do
+ * not share it.
+ */
+static _Thread_local uint32_t cuckoo_rng = 2463534242u;
+
+static inline int cuckoo_victim(void){
+    cuckoo_rng ^= cuckoo_rng << 13;
+    cuckoo_rng ^= cuckoo_rng >> 17;
+    cuckoo_rng ^= cuckoo_rng << 5;
+    return (int) (cuckoo_rng % CUCKOO_SLOTS);
+}
+
+/* puts carry in one of its buckets, moving other keys to their other
+ * bucket to make room, or in the stash.  Returns 0, or -1 with the table
+ * as it was if neither has room
+ */
+static int cuckoo_place(table_t *T, table_entry_t carry){
+    int moved[CUCKOO_KICKS];
+    int b1, b2, b, slot, kicks;
+
+    cuckoo_buckets(T, carry.key, &b1, &b2);
+    if((slot = cuckoo_free_slot(T, b1)) != -1 || (slot = cuckoo_free_slot(T, b2)) != -1){
+        entry_set(T, slot, carry);
+        return 0;
+    }
+    b = b1;
+    for(kicks = 0; kicks < CUCKOO_KICKS; kicks++){
+        slot = b * CUCKOO_SLOTS + cuckoo_victim();
+        moved[kicks] = slot; //remembered so a failed insert can be undone
+        table_entry_t next = entry_get(T, slot);
+        entry_set(T, slot, carry);
+        carry = next;
+        cuckoo_buckets(T, carry.key, &b1, &b2);
+        b = (b == b1) ? b2 : b1; //the bucket carry was not in
+        if((slot = cuckoo_free_slot(T, b)) != -1){
+            entry_set(T, slot, carry);
+            return 0;
+        }
+    }
+    if(T->stash_used < CUCKOO_STASH){
+        T->stash[T->stash_used++] = carry;
+        return 0;
+    }
+    while(kicks-- > 0){ //moves every key back, which leaves the new key in carry
+        table_entry_t next = entry_get(T, moved[kicks]);
+        entry_set(T, moved[kicks], carry);
+        carry = next;
+    }
+    return -1;
+}
+
+static int cuckoo_insert(table_t *T, hashkey_t K, data_t I){
+    int index = cuckoo_find(T, K);
+    if(index != -1){
+        data_t *dp = (index < T->table_size_M) ? &DATA(T, index) : &T->stash[index - T->table_size_M].data_ptr;
+        data_free(T, *dp);
+        *dp = I;
+        return 1;
+    }
+    if(table_full(T) == 1){
+        return -1;
+    }
+    table_entry_t carry = {K, I};
+    if(cuckoo_place(T, carry) == -1){
+        return -1;
+    }
+    T->num_keys_stored_in_table++;
+    return 0;
+}
+
+static int cuckoo_delete(table_t *T, hashkey_t K, data_t *I){
+    int index = cuckoo_find(T, K);
+    if(index == -1){
+        return 0;
+    }
+    if(index >= T->table_size_M){
+        index -= T->table_size_M;
+        *I = T->stash[index].data_ptr;
+        T->stash[index] = T->stash[--T->stash_used]; //the stash is not ordered
+    }
+    else{
+        *I = DATA(T, index);
+        KEY(T, index) = EMPTYKEY;
+        DATA(T, index) = NULL;
+        // the free slot may be one a stashed key can go back to
+        for(int i = 0; i < T->stash_used; ){
+            int b1, b2, slot;
+            cuckoo_buckets(T, T->stash[i].key, &b1, &b2);
+            if((slot = cuckoo_free_slot(T, b1)) != -1 || (slot = cuckoo_free_slot(T, b2)) != -1){
+                entry_set(T, slot, T->stash[i]);
+                T->stash[i] = T->stash[--T->stash_used];
+            }
+            else{
+                i++;
+            }
+        }
+    }
+    T->num_keys_stored_in_table--;
+    return 1;
+}
 
-    for(int i = 0; i < table_size; i++){
-        table->oa[i].key = EMPTYKEY; //gives values to all keys in oa
-    } 
+/* table_construct without filling the arrays with EMPTYKEY, so that an
+ * automatic resize can fill them a few slots at a time
+ */
+static table_t *table_alloc(int table_size, int probe_type){
+    int options = probe_type & TABLE_OPTIONS;
+    int bits = 0;
+
+    probe_type &= ~TABLE_OPTIONS;
+    if(options & TABLE_POW2){
+        while((1 << bits) < table_size){ //rounds the size up to a power of two
+            bits++;
+        }
+        assert(bits >= 1 && bits <= 30);
+        table_size = 1 << bits;
+    }
+    if(probe_type == SWISS){
+        if(table_size < SWISS_GROUP){
+            table_size = SWISS_GROUP;
+        }
+        table_size = (table_size + SWISS_GROUP - 1) / SWISS_GROUP * SWISS_GROUP; //whole groups only
+    }
+    if(probe_type == CUCKOO){
+        if(table_size < 2 * CUCKOO_SLOTS){
+            table_size = 2 * CUCKOO_SLOTS;
+        }
+        table_size = (table_size + CUCKOO_SLOTS - 1) / CUCKOO_SLOTS * CUCKOO_SLOTS; //whole buckets only
+    }
+    table_t *table = malloc(sizeof(table_t)); //mallocs table
+    if(options & TABLE_SOA){
+        // sizes rounded up to whole cache lines so the keys of a cuckoo
+        // bucket share one line
+        size_t key_bytes = (sizeof(hashkey_t) * table_size + 63) / 64 * 64;
+        size_t val_bytes = (sizeof(data_t) * table_size + 63) / 64 * 64;
+        table->oa = NULL;
+        table->key_base = aligned_alloc(64, key_bytes);
+        table->val_base = aligned_alloc(64, val_bytes);
+        assert(table->key_base != NULL && table->val_base != NULL);
+        table->key_stride = sizeof(hashkey_t);
+        table->val_stride = sizeof(data_t);
+    }
+    else{
+        if(probe_type == CUCKOO){
+            table->oa = aligned_alloc(64, sizeof(table_entry_t) * table_size); //each bucket on its own cache line
+        }
+        else{
+            table->oa = malloc(sizeof(table_entry_t) * table_size); //mallocs oa
+        }
+        assert(table->oa != NULL);
+        table->key_base = (char *) &table->oa[0].key;
+        table->val_base = (char *) &table->oa[0].data_ptr;
+        table->key_stride = table->val_stride = sizeof(table_entry_t);
+    }
 
     table->table_size_M = table_size; //sets values for table info
     table->type_of_probing_used_for_this_table = probe_type;
+    table->table_options = options;
+    table->hash_bits = bits;
     table->num_keys_stored_in_table = 0;
     table->num_probes_for_most_recent_call = 0;
     table->deletedkeys = 0;
+    table->ctrl = NULL;
+    if(probe_type == SWISS){
+        table->ctrl = aligned_alloc(SWISS_GROUP, table_size); //group loads need 16-byte alignment
+        assert(table->ctrl != NULL);
+    }
+    table->stash = NULL;
+    table->stash_used = 0;
+    table->max_load = 0.0;
+    table->max_deleted = 0.0;
+    table->compact_deleted = 0.0;
+    table->old = NULL;
+    table->migrate_pos = 0;
+    table->next = NULL;
+    table->next_filled = 0;
+    table->retired = NULL;
+    table->retire_pos = 0;
+    table->counts = NULL;
+    if(probe_type == CUCKOO){
+        table->stash = malloc(sizeof(table_entry_t) * CUCKOO_STASH);
+        assert(table->stash != NULL);
+    }
 
     return table;
 }
 
+/* makes slots from to to-1 empty */
+static void table_fill(table_t *T, int from, int to){
+    for(int i = from; i < to; i++){
+        KEY(T, i) = EMPTYKEY; //gives values to all keys
+        DATA(T, i) = NULL; //table_destruct frees every non-NULL data_ptr
+    }
+    if(T->ctrl != NULL){
+        for(int i = from; i < to; i++){
+            T->ctrl[i] = SWISS_EMPTY;
+        }
+    }
+}
+
+/* frees the arrays and T but none of the data */
+static void table_free(table_t *T){
+    if(T->oa != NULL){
+        free(T->oa); //frees oa
+    }
+    else{ //TABLE_SOA
+        free(T->key_base);
+        free(T->val_base);
+    }
+    free(T->ctrl);
+    free(T->stash);
+    free(T->counts);
+    free(T); //frees the table last
+}
+
+table_t *table_construct(int table_size, int probe_type){
+    table_t *table = table_alloc(table_size, probe_type);
+    table_fill(table, 0, table->table_size_M);
+#ifdef TABLE_STATS
+    table->counts = calloc(1, sizeof(struct table_stats));
+    assert(table->counts != NULL);
+#endif
+    return table;
+}
+
+static void table_migrate(table_t *T, int slots); //with the automatic resizing below
+
 table_t *table_rehash(table_t *T, int new_table_size){
-    table_t *newtable = table_construct(new_table_size, T->type_of_probing_used_for_this_table);
+    if(T->old != NULL){
+        table_migrate(T, INT_MAX); //finishes an automatic resize first
+    }
+    table_t *newtable = table_construct(new_table_size, T->type_of_probing_used_for_this_table | T->table_options);
+    free(newtable->counts); //the counts go on with T's, without the inserts below
+    newtable->counts = NULL;
     for(int i = 0; i < T->table_size_M; i++){ //goes and reinserts nonempty or not deleted keys into the new table
-        if(T->oa[i].key != EMPTYKEY && T->oa[i].key != DELETEKEY){
-            table_insert(newtable, T->oa[i].key, T->oa[i].data_ptr);
-            T->oa[i].data_ptr = NULL; //nullifies the data pointers from the old table
+        if(KEY(T, i) != EMPTYKEY && KEY(T, i) != DELETEKEY){
+            table_insert(newtable, KEY(T, i), DATA(T, i));
+            DATA(T, i) = NULL; //nullifies the data pointers from the old table
         }
     }
-    //table_destruct(T);
+    for(int i = 0; i < T->stash_used; i++){
+        table_insert(newtable, T->stash[i].key, T->stash[i].data_ptr);
+        T->stash[i].data_ptr = NULL;
+    }
+    newtable->max_load = T->max_load;
+    newtable->max_deleted = T->max_deleted;
+    newtable->compact_deleted = T->compact_deleted;
+    newtable->counts = T->counts;
+    T->counts = NULL;
+    table_destruct(T); //every data_ptr is NULL now, so only the arrays are freed
     return newtable;
 }  
 
+/* ----- compaction -----
+ *
+ * every DELETEKEY becomes empty and every key is put back where an insert
+ * into the compacted table would put it, without a second table.  A key is
+ * "pending" until it is put back.  Each key goes to the first slot of its
+ * probe sequence that is empty or pending: if that is its own slot it
+ * stays, if it is empty the key moves there, and if it holds another
+ * pending key the two swap and the other key is placed next, from the
+ * same slot, so each swap places one key for good.  A placed key never
+ * moves again, so every slot before it in its probe sequence stays full
+ * and searches still find it.  The slot a key came from is pending (it
+ * is in the probe sequence) so a key never goes past it.
+ */
+
+/* LINEAR, DOUBLE, and QUAD.  pending is a bitmap, 1/128 of the table */
+static void oa_compact(table_t *T){
+    int M = T->table_size_M;
+    unsigned char *pending = calloc((size_t) M / 8 + 1, 1);
+    assert(pending != NULL);
+    for(int i = 0; i < M; i++){
+        if(KEY(T, i) == DELETEKEY){
+            KEY(T, i) = EMPTYKEY;
+            DATA(T, i) = NULL;
+        }
+        else if(KEY(T, i) != EMPTYKEY){
+            pending[i >> 3] |= 1 << (i & 7);
+        }
+    }
+    for(int i = 0; i < M; i++){
+        while(pending[i >> 3] & (1 << (i & 7))){
+            hashkey_t K = KEY(T, i);
+            int index = H(K,T);
+            int probedec = P(K,T);
+            for(int n = 0; KEY(T, index) != EMPTYKEY && !(pending[index >> 3] & (1 << (index & 7))); n++){
+                assert(n <= M); //slot i is in the sequence, an insert put K there
+                if(T->type_of_probing_used_for_this_table == QUAD){
+                    probedec++;
+                }
+                index = probe_next(T, index, probedec);
+            }
+            pending[index >> 3] &= ~(1 << (index & 7)); //K is placed for good
+            if(index == i){
+                break;
+            }
+            table_entry_t entry = entry_get(T, index); //empty, or the next key to place
+            entry_set(T, index, entry_get(T, i));
+            entry_set(T, i, entry);
+            if(entry.key == EMPTYKEY){
+                pending[i >> 3] &= ~(1 << (i & 7));
+            }
+        }
+    }
+    free(pending);
+}
+
+/* SWISS.  The control bytes mark the pending keys with SWISS_DELETED, and
+ * a key stays where it is if its slot is in the first group with room,
+ * since a search reads the whole group
+ */
+static void swiss_compact(table_t *T){
+    int M = T->table_size_M;
+    int groups = M / SWISS_GROUP;
+    for(int i = 0; i < M; i++){
+        if(T->ctrl[i] == SWISS_DELETED){
+            T->ctrl[i] = SWISS_EMPTY;
+            KEY(T, i) = EMPTYKEY;
+            DATA(T, i) = NULL;
+        }
+        else if(T->ctrl[i] != SWISS_EMPTY){
+            T->ctrl[i] = SWISS_DELETED;
+        }
+    }
+    for(int i = 0; i < M; i++){
+        while(T->ctrl[i] == SWISS_DELETED){
+            uint64_t h = hash_mix(KEY(T, i));
+            int g = swiss_group(T, h);
+            unsigned m;
+            for(int n = 0; (m = swiss_match_free(T->ctrl + g * SWISS_GROUP)) == 0; n++){
+                assert(n < groups); //the group of slot i has room
+                g = (g == 0) ? groups - 1 : g - 1;
+            }
+            if(g == i / SWISS_GROUP){
+                T->ctrl[i] = swiss_h2(h);
+                break;
+            }
+            int index = g * SWISS_GROUP + __builtin_ctz(m);
+            unsigned char c = T->ctrl[index];
+            table_entry_t entry = entry_get(T, index);
+            entry_set(T, index, entry_get(T, i));
+            entry_set(T, i, entry);
+            T->ctrl[index] = swiss_h2(h);
+            T->ctrl[i] = c; //empty, or the next key to place
+        }
+    }
+}
+
+void table_compact(table_t *T){
+    if(T->old != NULL){
+        table_migrate(T, INT_MAX); //finishes an automatic resize first
+    }
+    if(T->next != NULL){ //arrays an automatic resize prepared for the deleted keys
+        table_free(T->next);
+        T->next = NULL;
+    }
+    if(T->deletedkeys == 0){
+        return; //ROBINHOOD and CUCKOO never have any
+    }
+    if(T->type_of_probing_used_for_this_table == SWISS){
+        swiss_compact(T);
+    }
+    else{
+        oa_compact(T);
+    }
+    T->deletedkeys = 0;
+}
+
+void table_set_autocompact(table_t *T, double max_deleted){
+    assert(max_deleted > 0.0);
+    T->compact_deleted = max_deleted;
+}
+
 int table_entries(table_t *T){
+    if(T->old != NULL){ //keys not yet moved by a resize
+        return T->num_keys_stored_in_table + T->old->num_keys_stored_in_table;
+    }
     return T->num_keys_stored_in_table; //returns number of keys in table
 }
 
+int table_size(table_t *T){
+    return T->table_size_M; //returns the number of positions, after any rounding
+}
+
 int table_full(table_t *T){
 
     if(T->num_keys_stored_in_table == T->table_size_M-1){ //checks and returns if the table is full
@@ -85,10 +798,26 @@ int table_full(table_t *T){
 }
 
 int table_deletekeys(table_t *T){
+    if(T->old != NULL){
+        return T->deletedkeys + T->old->deletedkeys;
+    }
     return T->deletedkeys; //returns number of deleted keys
 }
 
-int table_insert(table_t *T, hashkey_t K, data_t I){
+/* the insert, delete, and retrieve of one table; the table_ functions add
+ * the automatic resizing on top.  Delete and retrieve return 1 and set *I
+ * if K is found, since with TABLE_INLINE a NULL I is the value 0.
+ */
+static int oa_insert(table_t *T, hashkey_t K, data_t I){
+    if(T->type_of_probing_used_for_this_table == ROBINHOOD){
+        return rh_insert(T, K, I);
+    }
+    if(T->type_of_probing_used_for_this_table == SWISS){
+        return swiss_insert(T, K, I);
+    }
+    if(T->type_of_probing_used_for_this_table == CUCKOO){
+        return cuckoo_insert(T, K, I);
+    }
     T->num_probes_for_most_recent_call = 0;
     // if(table_full(T) == 1){
     //     return -1;
@@ -97,24 +826,21 @@ int table_insert(table_t *T, hashkey_t K, data_t I){
     int index = H(K,T);
     int probedec = P(K,T);
     int deleteslot = -1;
-    while((T->oa[index].key != EMPTYKEY)){//loops until valid empty key is found
+    while((KEY(T, index) != EMPTYKEY)){//loops until valid empty key is found
         T->num_probes_for_most_recent_call++;
-        if(T->oa[index].key == K){
+        if(KEY(T, index) == K){
             T->num_probes_for_most_recent_call++;
-            free(T->oa[index].data_ptr);
-            T->oa[index].data_ptr = I;
+            data_free(T, DATA(T, index));
+            DATA(T, index) = I;
             return 1; //sent when a key is replaced with a new data_ptr
         }
-        if(T->oa[index].key == DELETEKEY && deleteslot == -1){
+        if(KEY(T, index) == DELETEKEY && deleteslot == -1){
             deleteslot = index; //goes back to last seen deleted key if there were no empty keys
         }
         if(T->type_of_probing_used_for_this_table == QUAD){
             probedec++; //used for quadratic probing
         }
-        index -= probedec; //decrements
-        if(index < 0){
-            index += T->table_size_M; //loops around the table
-        }
+        index = probe_next(T, index, probedec); //decrements and loops around the table
         if(T->num_probes_for_most_recent_call > T->table_size_M){
             break;
         }
@@ -127,17 +853,26 @@ int table_insert(table_t *T, hashkey_t K, data_t I){
         assert(0 <= deleteslot && deleteslot < T->table_size_M);
         index = deleteslot;
     }
-    // else if(T->oa[index].key == DELETEKEY){
+    // else if(KEY(T, index) == DELETEKEY){
     //     T->deletedkeys--;
     // }
     T->num_probes_for_most_recent_call++;
-    T->oa[index].key = K;
-    T->oa[index].data_ptr = I;
+    KEY(T, index) = K;
+    DATA(T, index) = I;
     T->num_keys_stored_in_table++;
     return 0; //returns 0 when a new key replaces a previously empty key or deleted key
 }
 
-data_t table_delete(table_t *T, hashkey_t K){
+static int oa_delete(table_t *T, hashkey_t K, data_t *I){
+    if(T->type_of_probing_used_for_this_table == ROBINHOOD){
+        return rh_delete(T, K, I);
+    }
+    if(T->type_of_probing_used_for_this_table == SWISS){
+        return swiss_delete(T, K, I);
+    }
+    if(T->type_of_probing_used_for_this_table == CUCKOO){
+        return cuckoo_delete(T, K, I);
+    }
     T->num_probes_for_most_recent_call = 0;
     int index = H(K,T);
     int probedec = P(K,T);
@@ -145,39 +880,59 @@ data_t table_delete(table_t *T, hashkey_t K){
     table_entry_t probe;
     //probe = malloc(sizeof(probe));
     //probe->key = malloc(sizeof(sizeof(hashkey_t)));
-    probe.key = T->oa[index].key; //gets initial index value
-    probe.data_ptr = T->oa[index].data_ptr;
+    probe.key = KEY(T, index); //gets initial index value, the data_ptr is only read once K is found
     while((probe.key != K) && (probe.key != EMPTYKEY)){ //loops until the valid key or empty key is found
         T->num_probes_for_most_recent_call++;
         if(T->type_of_probing_used_for_this_table == QUAD){
             probedec++; //used for quad probing to decrement
         }
-        index -= probedec;
-        if(index < 0){
-            index += T->table_size_M;
-        }
-        probe.key = T->oa[index].key;
-        probe.data_ptr = T->oa[index].data_ptr;
+        index = probe_next(T, index, probedec);
+        probe.key = KEY(T, index);
         if(T->num_probes_for_most_recent_call > T->table_size_M){
-            return NULL;
+            return 0;
         }
     }
-    if(probe.key == EMPTYKEY){ //returns NULL since no key was found
+    if(probe.key == EMPTYKEY){ //returns 0 since no key was found
         T->num_probes_for_most_recent_call++;
-        return NULL;
+        return 0;
     }
     else{
         T->num_probes_for_most_recent_call++;
-        T->oa[index].key = DELETEKEY;
-        T->oa[index].data_ptr = NULL;
+        *I = DATA(T, index); //gives back data_ptr of the key that was meant to be deleted
+        KEY(T, index) = DELETEKEY;
+        DATA(T, index) = NULL;
         T->num_keys_stored_in_table--;
         T->deletedkeys++;
-        return probe.data_ptr; //return data_ptr of the key that was meant to be deleted
+        return 1;
     }
-    return NULL;
+    return 0;
 }
 
-data_t table_retrieve(table_t *T, hashkey_t K){
+static int oa_retrieve(table_t *T, hashkey_t K, data_t *I){
+    if(T->type_of_probing_used_for_this_table == ROBINHOOD){
+        int index = rh_find(T, K);
+        if(index == -1){
+            return 0;
+        }
+        *I = DATA(T, index);
+        return 1;
+    }
+    if(T->type_of_probing_used_for_this_table == SWISS){
+        int index = swiss_find(T, K, NULL);
+        if(index == -1){
+            return 0;
+        }
+        *I = DATA(T, index);
+        return 1;
+    }
+    if(T->type_of_probing_used_for_this_table == CUCKOO){
+        int index = cuckoo_find(T, K);
+        if(index == -1){
+            return 0;
+        }
+        *I = index < T->table_size_M ? DATA(T, index) : T->stash[index - T->table_size_M].data_ptr;
+        return 1;
+    }
     T->num_probes_for_most_recent_call = 0;
     int index = H(K,T);
     int probedec = P(K,T);
@@ -185,19 +940,14 @@ data_t table_retrieve(table_t *T, hashkey_t K){
     table_entry_t probe;
     //probe = malloc(sizeof(probe));
     //probe->key = malloc(sizeof(sizeof(hashkey_t)));
-    probe.key = T->oa[index].key;
-    probe.data_ptr = T->oa[index].data_ptr;
+    probe.key = KEY(T, index); //only keys are compared, so the data_ptr is read once K is found
     while((probe.key != K) && (probe.key != EMPTYKEY)){ //loops until empty key or wanted key is found
         T->num_probes_for_most_recent_call++;
         if(T->type_of_probing_used_for_this_table == QUAD){ //used for quad probing
             probedec++;
         }
-        index -= probedec;
-        if(index < 0){ //loops through the table
-            index += T->table_size_M;
-        }
-        probe.key = T->oa[index].key;
-        probe.data_ptr = T->oa[index].data_ptr;
+        index = probe_next(T, index, probedec); //loops through the table
+        probe.key = KEY(T, index);
         if(T->num_probes_for_most_recent_call > T->table_size_M){
             probe.key = EMPTYKEY;
             break; //breaks once all index have been searched
@@ -205,34 +955,503 @@ data_t table_retrieve(table_t *T, hashkey_t K){
     }
     if(probe.key == EMPTYKEY || probe.key == DELETEKEY){
         T->num_probes_for_most_recent_call++;
-        return NULL; //returns null since the key was not found
+        return 0; //returns 0 since the key was not found
     }
     else{
         T->num_probes_for_most_recent_call++;
-        return probe.data_ptr; //returns data_ptr value of key that was searched for
+        *I = DATA(T, index); //gives back data_ptr value of key that was searched for
+        return 1;
+    }
+    return 0;
+}
+
+/* ----- automatic resizing -----
+ *
+ * when an insert or delete finds the table too full or with too many
+ * deleted slots, the arrays move to a new table_t kept in T->old, and T
+ * gets new empty arrays.  Every insert and delete after that moves the
+ * keys of the next MIGRATE_SLOTS slots of the old arrays into T, and when
+ * the last one is moved the old arrays are freed.  Until then a key is in
+ * exactly one of the two, and a search that misses in T looks in T->old.
+ *
+ * The new size is doubled until the keys fill at most half of max_load,
+ * so the inserts made while the old arrays are moved cannot start another
+ * resize before the move is done.
+ *
+ * Filling new arrays with EMPTYKEY touches every page of them, which for
+ * a big table takes longer than moving the keys.  So once the keys or the
+ * deleted slots pass half of their limit, T->next gets the arrays for the
+ * resize, and every insert and delete fills PREPARE_SLOTS of them.  The
+ * resize then only has to fill what is left, if anything.
+ *
+ * Freeing the old arrays costs the same again, since the system has to
+ * take back every page, so when the move is done they go to T->retired
+ * and each insert and delete gives RETIRE_PAGES of them back with madvise
+ * before the last one frees them.  Nothing reads them after the move.
+ */
+static int next_prime(int n){
+    for(;; n++){
+        int prime = n > 1;
+        for(int d = 2; prime && d <= n / d; d++){
+            prime = (n % d != 0);
+        }
+        if(prime){
+            return n;
+        }
+    }
+}
+
+/* the deleted positions are counted against the positions without a key,
+ * since a search stops only at an empty one; against the table size they
+ * could fill every empty position of a full table without a resize
+ */
+static int table_needs_resize(table_t *T){
+    return T->old == NULL &&
+        (table_entries(T) + 1 > T->max_load * T->table_size_M ||
+         T->deletedkeys > T->max_deleted * (T->table_size_M - T->num_keys_stored_in_table));
+}
+
+/* returns the size of the new arrays for a resize with keys entries, at
+ * least 2 positions so that one stays empty
+ */
+static int table_resize_size(table_t *T, int keys){
+    int new_M = T->table_size_M < 2 ? 2 : T->table_size_M;
+    while(keys > T->max_load / 2 * new_M){
+        assert(new_M <= INT_MAX / 2);
+        new_M *= 2;
+    }
+    if(T->type_of_probing_used_for_this_table == DOUBLE && !(T->table_options & TABLE_POW2)){
+        new_M = next_prime(new_M); //the decrement only covers a table of prime size
+    }
+    return new_M;
+}
+
+static void table_prepare(table_t *T){
+    if(T->next == NULL){
+        int keys;
+        if(T->num_keys_stored_in_table > T->max_load / 2 * T->table_size_M){
+            keys = (int) (T->max_load * T->table_size_M); //the keys when the resize starts
+        }
+        else if(T->deletedkeys > T->max_deleted / 2 * (T->table_size_M - T->num_keys_stored_in_table)){
+            keys = T->num_keys_stored_in_table;
+        }
+        else{
+            return;
+        }
+        T->next = table_alloc(table_resize_size(T, keys), T->type_of_probing_used_for_this_table | T->table_options);
+        T->next_filled = 0;
+    }
+    int to = T->next_filled + PREPARE_SLOTS;
+    if(to > T->next->table_size_M){
+        to = T->next->table_size_M;
+    }
+    table_fill(T->next, T->next_filled, to);
+    T->next_filled = to;
+}
+
+static void table_resize_start(table_t *T){
+    int new_M = table_resize_size(T, T->num_keys_stored_in_table + 1); //and the key being inserted
+    table_t *newtable;
+
+    assert(T->old == NULL);
+    if(T->next != NULL && T->next->table_size_M >= new_M){
+        newtable = T->next;
+        table_fill(newtable, T->next_filled, newtable->table_size_M); //usually nothing is left
+    }
+    else{ //the keys grew faster than the prepared arrays
+        if(T->next != NULL){
+            table_free(T->next);
+        }
+        newtable = table_construct(new_M, T->type_of_probing_used_for_this_table | T->table_options);
+    }
+    T->next = NULL;
+    table_t *old = malloc(sizeof(table_t));
+    *old = *T; //the old arrays go to old, and T takes the new ones
+    newtable->max_load = T->max_load;
+    newtable->max_deleted = T->max_deleted;
+    newtable->compact_deleted = T->compact_deleted;
+    newtable->retired = T->retired; //arrays from the resize before stay with T
+    newtable->retire_pos = T->retire_pos;
+    free(newtable->counts);
+    newtable->counts = T->counts;
+    *T = *newtable;
+    free(newtable);
+    old->max_load = 0.0;
+    old->retired = NULL;
+    old->counts = NULL;
+    T->old = old;
+    T->migrate_pos = 0;
+    // deleting an old key can pull a stashed key back into a slot that was
+    // already moved, so the stash goes first
+    while(old->stash_used > 0){
+        table_entry_t entry = old->stash[--old->stash_used];
+        old->num_keys_stored_in_table--;
+        oa_insert(T, entry.key, entry.data_ptr);
+    }
+}
+
+/* moves the keys of up to slots old slots into T */
+static void table_migrate(table_t *T, int slots){
+    table_t *old = T->old;
+    int probes = T->num_probes_for_most_recent_call; //table_stats is for the caller's operation
+    hashkey_t key;
+
+    while(slots-- > 0 && T->migrate_pos < old->table_size_M){
+        // a delete may move another key into this slot (Robin Hood moves
+        // the rest of the run back), so look at it again until it is empty
+        while((key = KEY(old, T->migrate_pos)) != EMPTYKEY && key != DELETEKEY){
+            data_t I;
+            oa_delete(old, key, &I);
+            oa_insert(T, key, I);
+        }
+        T->migrate_pos++;
+    }
+    if(T->migrate_pos == old->table_size_M){
+        assert(old->num_keys_stored_in_table == 0);
+        if(T->retired != NULL){ //still giving back the ones from the resize before
+            table_free(T->retired);
+        }
+        T->retired = old; //only the arrays are left to free
+        T->retire_pos = 0;
+        T->old = NULL;
+    }
+    T->num_probes_for_most_recent_call = probes;
+}
+
+static void table_retire(table_t *T){
+    table_t *R = T->retired;
+#ifdef MADV_DONTNEED
+    // the keys, then for TABLE_SOA the data_ptrs.  Only whole pages of an
+    // array can go back
+    uintptr_t page = (uintptr_t) sysconf(_SC_PAGESIZE);
+    char *arrays[2] = {R->key_base, R->val_base};
+    int strides[2] = {R->key_stride, R->val_stride};
+    uintptr_t pos = (uintptr_t) T->retire_pos;
+    for(int a = 0; a < (R->oa == NULL ? 2 : 1); a++){
+        uintptr_t first = ((uintptr_t) arrays[a] + page - 1) & ~(page - 1);
+        uintptr_t end = ((uintptr_t) arrays[a] + (uintptr_t) R->table_size_M * strides[a]) & ~(page - 1);
+        uintptr_t pages = end > first ? end - first : 0;
+        if(pos < pages){
+            size_t len = RETIRE_PAGES * page;
+            if(len > pages - pos){
+                len = pages - pos;
+            }
+            madvise((void *) (first + pos), len, MADV_DONTNEED);
+            T->retire_pos += (long) len;
+            return;
+        }
+        pos -= pages;
     }
-    return NULL;
+#endif
+    table_free(R);
+    T->retired = NULL;
+}
+
+void table_set_autoresize(table_t *T, double max_load, double max_deleted){
+    assert(0.0 < max_load && max_load < 1.0 && max_deleted > 0.0);
+    T->max_load = max_load;
+    T->max_deleted = max_deleted;
+}
+
+int table_insert(table_t *T, hashkey_t K, data_t I){
+    if(T->max_load == 0.0){
+        int code = oa_insert(T, K, I);
+        stats_count(T, TABLE_OP_INSERT);
+        return code;
+    }
+    if(table_needs_resize(T)){
+        table_resize_start(T);
+    }
+    else if(T->old == NULL){
+        table_prepare(T);
+    }
+    int code;
+    data_t old_I;
+    if(T->old != NULL && oa_delete(T->old, K, &old_I)){ //K moves now with its new I
+        int probes = T->old->num_probes_for_most_recent_call;
+        data_free(T, old_I);
+        oa_insert(T, K, I);
+        T->num_probes_for_most_recent_call += probes;
+        code = 1;
+    }
+    else{
+        code = oa_insert(T, K, I);
+    }
+    if(code == -1){ //cuckoo can run out of room below max_load
+        if(T->old != NULL){
+            table_migrate(T, INT_MAX);
+        }
+        table_resize_start(T);
+        code = oa_insert(T, K, I);
+    }
+    if(T->old != NULL){
+        table_migrate(T, MIGRATE_SLOTS);
+    }
+    else if(T->retired != NULL){
+        table_retire(T);
+    }
+    stats_count(T, TABLE_OP_INSERT);
+    return code;
+}
+
+/* table_delete and table_delete_value */
+static int table_remove(table_t *T, hashkey_t K, data_t *I){
+    int found = oa_delete(T, K, I);
+    if(T->compact_deleted != 0.0 && T->deletedkeys > T->compact_deleted * T->table_size_M){
+        table_compact(T); //leaves table_stats for the delete
+    }
+    if(T->max_load == 0.0){
+        stats_count(T, TABLE_OP_DELETE);
+        return found;
+    }
+    if(!found && T->old != NULL){
+        int probes = T->num_probes_for_most_recent_call;
+        found = oa_delete(T->old, K, I);
+        T->num_probes_for_most_recent_call = probes + T->old->num_probes_for_most_recent_call;
+    }
+    if(table_needs_resize(T)){
+        table_resize_start(T);
+    }
+    else if(T->old == NULL){
+        table_prepare(T);
+    }
+    if(T->old != NULL){
+        table_migrate(T, MIGRATE_SLOTS);
+    }
+    else if(T->retired != NULL){
+        table_retire(T);
+    }
+    stats_count(T, TABLE_OP_DELETE);
+    return found;
+}
+
+data_t table_delete(table_t *T, hashkey_t K){
+    data_t I;
+    return table_remove(T, K, &I) ? I : NULL;
+}
+
+/* table_retrieve and table_retrieve_value */
+static int table_lookup(table_t *T, hashkey_t K, data_t *I){
+    int found = oa_retrieve(T, K, I);
+    if(!found && T->old != NULL){
+        int probes = T->num_probes_for_most_recent_call;
+        found = oa_retrieve(T->old, K, I);
+        T->num_probes_for_most_recent_call = probes + T->old->num_probes_for_most_recent_call;
+    }
+    stats_count(T, TABLE_OP_RETRIEVE);
+    return found;
+}
+
+data_t table_retrieve(table_t *T, hashkey_t K){
+    data_t I;
+    return table_lookup(T, K, &I) ? I : NULL;
+}
+
+/* ----- inline values -----
+ *
+ * a TABLE_INLINE value is kept in the bits of the data_ptr, so the value
+ * functions are the pointer ones with a cast on the way in and out
+ */
+int table_insert_value(table_t *T, hashkey_t K, uint64_t V){
+    assert(T->table_options & TABLE_INLINE);
+    assert(V <= UINTPTR_MAX); //always true with 64-bit pointers
+    return table_insert(T, K, (data_t) (uintptr_t) V);
+}
+
+int table_delete_value(table_t *T, hashkey_t K, uint64_t *V){
+    data_t I;
+    assert(T->table_options & TABLE_INLINE);
+    if(!table_remove(T, K, &I)){
+        return 0;
+    }
+    if(V != NULL){
+        *V = (uint64_t) (uintptr_t) I;
+    }
+    return 1;
+}
+
+int table_retrieve_value(table_t *T, hashkey_t K, uint64_t *V){
+    data_t I;
+    assert(T->table_options & TABLE_INLINE);
+    if(!table_lookup(T, K, &I)){
+        return 0;
+    }
+    if(V != NULL){
+        *V = (uint64_t) (uintptr_t) I;
+    }
+    return 1;
+}
+
+/* ----- batches -----
+ *
+ * in a table much bigger than the cache every lookup waits for the cache
+ * miss on its home slot, and one lookup cannot start before the one
+ * before it ends.  The batch functions hash the key BATCH_AHEAD places
+ * further on and prefetch its home slot before they do the usual lookup
+ * of each key, so up to BATCH_AHEAD misses are on the way at once.
+ */
+
+/* puts the cache lines a lookup of K reads first in lines[] and returns
+ * how many there are.  The batch functions prefetch them themselves: gcc
+ * drops a call to a function that does nothing but prefetch.
+ */
+static inline int table_home_lines(table_t *T, hashkey_t K, const void *lines[4]){
+    int n = 0, home;
+    if(T->type_of_probing_used_for_this_table == SWISS){
+        home = swiss_group(T, hash_mix(K)) * SWISS_GROUP;
+        lines[n++] = T->ctrl + home;
+    }
+    else if(T->type_of_probing_used_for_this_table == CUCKOO){
+        int b1, b2;
+        cuckoo_buckets(T, K, &b1, &b2);
+        home = b1 * CUCKOO_SLOTS;
+        lines[n++] = &KEY(T, b2 * CUCKOO_SLOTS);
+    }
+    else{
+        home = H(K,T);
+    }
+    lines[n++] = &KEY(T, home);
+    if(T->oa == NULL){ //TABLE_SOA, a hit also reads the data_ptr array
+        lines[n++] = &DATA(T, home);
+    }
+    return n;
+}
+
+int table_retrieve_batch(table_t *T, const hashkey_t *keys, int n, data_t *out){
+    const void *lines[4];
+    int found = 0;
+    assert(!(T->table_options & TABLE_INLINE)); //NULL would not tell a 0 from a miss
+    // the first BATCH_AHEAD times round only prefetch
+    for(int i = -BATCH_AHEAD; i < n; i++){
+        if(i + BATCH_AHEAD < n){
+            for(int j = table_home_lines(T, keys[i + BATCH_AHEAD], lines); j-- > 0; ){
+                __builtin_prefetch(lines[j], 0);
+            }
+        }
+        if(i >= 0){
+            out[i] = table_retrieve(T, keys[i]);
+            if(out[i] != NULL){
+                found++;
+            }
+        }
+    }
+    return found;
+}
+
+int table_insert_batch(table_t *T, const hashkey_t *keys, const data_t *data, int n, int *codes){
+    const void *lines[4];
+    int added = 0;
+    for(int i = -BATCH_AHEAD; i < n; i++){
+        if(i + BATCH_AHEAD < n){
+            for(int j = table_home_lines(T, keys[i + BATCH_AHEAD], lines); j-- > 0; ){
+                __builtin_prefetch(lines[j], 1);
+            }
+        }
+        if(i >= 0){
+            int code = table_insert(T, keys[i], data[i]);
+            if(codes != NULL){
+                codes[i] = code;
+            }
+            if(code == 0){
+                added++;
+            }
+        }
+    }
+    return added;
 }
 
 void table_destruct(table_t *T){
-    for(int i = 0; i < T->table_size_M; i++){ //loops and frees each data_ptr in oa
-            if(T->oa[i].data_ptr != NULL){
-                free(T->oa[i].data_ptr);
+    if(!(T->table_options & TABLE_INLINE)){ //inline values have nothing to free
+        for(int i = 0; i < T->table_size_M; i++){ //loops and frees each data_ptr
+            if(DATA(T, i) != NULL){
+                free(DATA(T, i));
             }
+        }
+        for(int i = 0; i < T->stash_used; i++){
+            free(T->stash[i].data_ptr);
+        }
     }
-    free(T->oa); //frees oa
-    free(T); //frees the table last
+    if(T->old != NULL){
+        table_destruct(T->old);
+    }
+    if(T->next != NULL){
+        table_free(T->next);
+    }
+    if(T->retired != NULL){
+        table_free(T->retired);
+    }
+    table_free(T);
 }
 
 int table_stats(table_t *T){
     return T->num_probes_for_most_recent_call; //returns the number of comparisons that were done in the last used function
 }
 
+int table_stats_bin(int length){
+    if(length < TABLE_STATS_EXACT){
+        return length;
+    }
+    return TABLE_STATS_BINS - __builtin_clz((unsigned) length); //2^5 to 2^6-1 is TABLE_STATS_EXACT
+}
+
+int table_stats_bin_min(int bin){
+    if(bin < TABLE_STATS_EXACT){
+        return bin;
+    }
+    return 1 << (bin - TABLE_STATS_EXACT + 5);
+}
+
+int table_get_stats(table_t *T, struct table_stats *S){
+    int M = T->table_size_M;
+    int start = 0, len = 0;
+
+    if(T->counts != NULL){
+        *S = *T->counts;
+    }
+    else{
+        *S = (struct table_stats) {0};
+    }
+    S->clusters = S->max_cluster = 0;
+    for(int i = 0; i < TABLE_STATS_BINS; i++){
+        S->cluster_hist[i] = 0;
+    }
+    while(start < M && KEY(T, start) != EMPTYKEY){
+        start++; //a run that wraps around the end is counted once, from an empty slot
+    }
+    for(int n = 1; n <= M; n++){
+        int i = (start + n) % M;
+        if(KEY(T, i) != EMPTYKEY){ //a SWISS or CUCKOO slot keeps EMPTYKEY while it is empty too
+            len++;
+            continue;
+        }
+        if(len > 0){
+            S->clusters++;
+            S->cluster_hist[table_stats_bin(len)]++;
+            if(len > S->max_cluster){
+                S->max_cluster = len;
+            }
+        }
+        len = 0;
+    }
+    if(len > 0){ //no empty slot at all
+        S->clusters = 1;
+        S->cluster_hist[table_stats_bin(len)]++;
+        S->max_cluster = len;
+    }
+    int free_slots = M - T->num_keys_stored_in_table;
+    S->tombstone_density = free_slots > 0 ? (double) T->deletedkeys / free_slots : 0.0;
+    return T->counts != NULL;
+}
+
 hashkey_t table_peek(table_t *T, int index){
     assert(0 <= index && index < T->table_size_M);
 
-    if(T->oa[index].data_ptr != NULL){
-        return T->oa[index].key; //returns key if the given index has a nonempty or not deleted data_ptr
+    if(T->ctrl != NULL){
+        // a SWISS slot is full when the high bit of its control byte is clear
+        return (T->ctrl[index] & 0x80) ? (hashkey_t) INT_MAX : KEY(T, index);
+    }
+    if(KEY(T, index) != EMPTYKEY && KEY(T, index) != DELETEKEY){
+        return KEY(T, index); //returns key if the given index is nonempty and not deleted, an inline value may be 0
     }
     else{
         return (hashkey_t) INT_MAX; //otherwise returns INT_MAX
@@ -241,7 +1460,7 @@ hashkey_t table_peek(table_t *T, int index){
 
 void table_debug_print(table_t *T){
     for(int i = 0; i < T->table_size_M; i++){ //loops through each index and prints the key value
-        table_entry_t entry = T->oa[i];
+        table_entry_t entry = entry_get(T, i);
         if(entry.key == EMPTYKEY){
             printf("%d: EMPTY KEY\n", i);
         }
@@ -252,5 +1471,8 @@ void table_debug_print(table_t *T){
             printf("%d: %d\n", i, entry.key);
         }
     }
+    for(int i = 0; i < T->stash_used; i++){ //cuckoo keys without a slot
+        printf("stash %d: %d\n", i, T->stash[i].key);
+    }
 }
 
@@ -3,8 +3,94 @@
  * Fall 2022
  */
 
-/* constants used to indicate type of probing.  */
-enum ProbeDec_t {LINEAR, DOUBLE, QUAD};
+#include <stdint.h>
+
+/* constants used to indicate type of probing.
+ *
+ * ROBINHOOD is linear probing that keeps each run of keys ordered by home
+ * position: an insert takes the slot of the first key that is closer to
+ * its own home than the new key is, and moves the rest of the run down by
+ * one.  No key is ever much further from home than its neighbours, a
+ * search can stop as soon as it passes where the key would have to be,
+ * and a delete moves the following keys of the run back by one instead of
+ * leaving a DELETEKEY, so table_deletekeys stays 0.
+ *
+ * SWISS keeps one control byte per slot next to the entries: 0x80 for
+ * empty, 0xFE for deleted, or 7 bits of the key's hash.  The slots are in
+ * groups of 16 and a search looks at all 16 control bytes of a group at
+ * once (with SSE2 when the compiler has it), and only reads an entry when
+ * its control byte matches.  The table size is rounded up to a multiple
+ * of 16 and keys are always hashed with the multiply-shift hash.  For
+ * SWISS, table_stats counts one probe per group and one per key compared.
+ *
+ * CUCKOO splits the table into buckets of 4 slots, each one 64-byte cache
+ * line, and gives every key two buckets from two multiply-shift hashes.
+ * A key is always in one of its two buckets or in a stash of 8 entries
+ * that only fills when an insert cannot find room, so a search reads at
+ * most two buckets and the stash, however the keys collide.  An insert
+ * with both buckets full moves a key out to its other bucket, up to 500
+ * times, and returns -1 (with the table unchanged) if that fails and the
+ * stash is full.  The table size is rounded up to a multiple of 4, and
+ * deletes leave no DELETEKEY.  For CUCKOO, table_stats counts the buckets
+ * read, plus one if the stash was searched.
+ */
+enum ProbeDec_t {LINEAR, DOUBLE, QUAD, ROBINHOOD, SWISS, CUCKOO};
+
+/* options that can be added to the probe type passed to table_construct,
+ * e.g. table_construct(size, LINEAR | TABLE_POW2)
+ *
+ * TABLE_POW2 rounds the table size up to a power of two and replaces
+ * abs(K) % M with a multiply-shift hash: K is multiplied by a 64-bit odd
+ * constant and the top bits of the product are the home position.  There
+ * is no division on the probe path, and runs of nearby keys are spread
+ * over the whole table instead of filling adjacent slots.  The double
+ * hashing decrement comes from the next bits of the product and is odd,
+ * so it covers every slot, and the quadratic sequence also covers every
+ * slot of a power-of-two table.
+ */
+#define TABLE_POW2   0x100
+
+/* TABLE_SOA keeps the keys in one array and the data pointers in another
+ * instead of an array of table_entry_t.  An entry is a 4-byte key and an
+ * 8-byte pointer padded to 16 bytes, so a probe sequence that only
+ * compares keys also pulls the pointers through the cache: 4 keys fit in
+ * a cache line of entries and 16 in a cache line of keys.
+ */
+#define TABLE_SOA    0x200
+
+/* TABLE_INLINE stores a uint64_t value in each entry in the place of the
+ * data pointer, for payloads that are just a number.  Use the _value
+ * functions below instead of table_insert, table_delete, and
+ * table_retrieve.  The table owns nothing: a replace and table_destruct
+ * free nothing, and no malloc is needed per entry.
+ */
+#define TABLE_INLINE 0x400
+#define TABLE_OPTIONS 0xff00   /* mask for all the option bits */
+
+/* what table_get_stats fills in.  The calls and probe counts are only kept
+ * when table.c is compiled with -DTABLE_STATS (make stats=-DTABLE_STATS);
+ * without it nothing is counted on any call and they stay 0.  The cluster
+ * and tombstone figures come from a scan of the table and are always
+ * there.  The histograms have a bin for each length below
+ * TABLE_STATS_EXACT and then one for each power of two, 32 to 63, 64 to
+ * 127, and so on up to INT_MAX, so a long tail is still placed within a
+ * factor of two.  table_stats_bin gives the bin of a length and
+ * table_stats_bin_min the least length in a bin.
+ */
+#define TABLE_STATS_EXACT 32
+#define TABLE_STATS_BINS 58     /* TABLE_STATS_EXACT, then 2^5 up to 2^30 */
+enum TableOp_t {TABLE_OP_INSERT, TABLE_OP_DELETE, TABLE_OP_RETRIEVE, TABLE_OPS};
+
+struct table_stats {
+    long calls[TABLE_OPS];      // by TableOp_t, the _value and _batch calls included
+    long probes[TABLE_OPS];     // table_stats summed over the calls
+    long probe_hist[TABLE_OPS][TABLE_STATS_BINS];  // calls by table_stats
+    int max_probes[TABLE_OPS];
+    long cluster_hist[TABLE_STATS_BINS];   // runs of full or deleted positions by length
+    int clusters;
+    int max_cluster;
+    double tombstone_density;   // positions marked deleted over positions without a key
+};
 
 typedef void *data_t;   /* pointer to the information, I, to be stored in the table */
 typedef int hashkey_t;   /* the key, K, for the pair (K, I) */
@@ -21,7 +107,26 @@ typedef struct table_tag {
     int num_keys_stored_in_table;
     int num_probes_for_most_recent_call;
     int deletedkeys;
-    table_entry_t *oa;
+    table_entry_t *oa;          // NULL with TABLE_SOA
+    char *key_base;             // the key of slot i is at key_base + i*key_stride
+    char *val_base;             // and its data_ptr at val_base + i*val_stride
+    int key_stride;
+    int val_stride;
+    int table_options;          // TABLE_POW2, TABLE_SOA, TABLE_INLINE
+    int hash_bits;              // table_size_M is 2^hash_bits for TABLE_POW2
+    unsigned char *ctrl;        // SWISS control bytes, NULL for the others
+    table_entry_t *stash;       // CUCKOO keys that did not fit, NULL for the others
+    int stash_used;
+    double max_load;            // table_set_autoresize limits, 0 when off
+    double max_deleted;
+    double compact_deleted;     // table_set_autocompact limit, 0 when off
+    struct table_tag *old;      // arrays still being moved by a resize, or NULL
+    int migrate_pos;            // next slot of old to move
+    struct table_tag *next;     // arrays being filled for the next resize, or NULL
+    int next_filled;            // slots of next filled so far
+    struct table_tag *retired;  // arrays moved out by a resize, being given back
+    long retire_pos;            // bytes of retired given back so far
+    struct table_stats *counts; // calls and probes with TABLE_STATS, else NULL
 } table_t;
 
 /*  The empty table is created.  The table must be dynamically allocated and
@@ -30,7 +135,11 @@ typedef struct table_tag {
  *  the table is filled with a special empty key distinct from all other 
  *  nonempty keys.  
  *
- *  The probe_type must be one of {LINEAR, DOUBLE, QUAD}
+ *  The probe_type must be one of {LINEAR, DOUBLE, QUAD, ROBINHOOD, SWISS,
+ *  CUCKOO}, plus any of the TABLE_ options.  With TABLE_POW2 the table_size
+ *  is rounded up to a power of two, SWISS rounds it up to a multiple of 16,
+ *  and CUCKOO to a multiple of 4; use table_size to find the size that was
+ *  used.
  *
  *  Do not "correct" the table_size or probe decrement if there is a chance
  *  that the combinaion of table size or probe decrement will not cover
@@ -48,13 +157,49 @@ table_t *table_construct(int table_size, int probe_type);
  * Do not rehash the table during an insert or delete function call.  Instead
  * use drivers to verify under what conditions rehashing is required, and
  * call the rehash function in the driver to show how the performance
- * can be improved.
+ * can be improved.  The exception is a table with table_set_autoresize.
  */
 table_t *table_rehash(table_t * T, int new_table_size);  
 
+/* Turn on automatic resizing.  When an insert would make the entries more
+ * than max_load of the table size, or when more than max_deleted of the
+ * positions without a key are marked deleted, the table starts moving to
+ * new arrays big enough that the entries fill half of max_load (the same
+ * size if the deleted positions are the only problem).  Instead of one
+ * long pause, each later insert and delete moves the keys of a few old
+ * positions, so the table is never full and no call rehashes the whole
+ * table.  While a resize is under way table_entries and table_deletekeys
+ * count both sets of arrays, and table_peek and table_size only see the
+ * new ones.
+ *
+ * 0 < max_load < 1.  A max_deleted of 1 or more never resizes for deleted
+ * positions.
+ */
+void table_set_autoresize(table_t *T, double max_load, double max_deleted);
+
+/* Clear every position marked deleted without a new table: the keys are
+ * moved around inside the table until each one is where an insert would
+ * put it if there had never been a delete.  Only a bitmap of 1 bit per
+ * position is allocated, where table_rehash needs a whole second table
+ * while it copies.  Nothing changes for ROBINHOOD and CUCKOO, which never
+ * mark positions deleted.
+ */
+void table_compact(table_t *T);
+
+/* Call table_compact whenever a delete leaves more than max_deleted of
+ * the positions marked deleted.  With table_set_autoresize as well, the
+ * lower of the two max_deleted limits acts first.
+ */
+void table_set_autocompact(table_t *T, double max_deleted);
+
 /* returns number of entries in the table */
 int table_entries(table_t *);
 
+/* returns the number of positions in the table, which is table_size from
+ * table_construct unless an option rounded it up
+ */
+int table_size(table_t *);
+
 /* returns 1 if table is full and 0 if not full. */
 int table_full(table_t *);
 
@@ -86,6 +231,29 @@ data_t table_delete(table_t *, hashkey_t K);
  */
 data_t table_retrieve(table_t *, hashkey_t K); 
 
+/* The same as table_insert, table_delete, and table_retrieve for a table
+ * constructed with TABLE_INLINE.  table_insert_value returns the same codes
+ * as table_insert.  table_delete_value and table_retrieve_value return 1 and
+ * copy the value to *V (if V is not NULL) when K is found, and 0 if it is
+ * not, since 0 is a value like any other.
+ */
+int table_insert_value(table_t *, hashkey_t K, uint64_t V);
+int table_delete_value(table_t *, hashkey_t K, uint64_t *V);
+int table_retrieve_value(table_t *, hashkey_t K, uint64_t *V);
+
+/* Look up or insert n keys at once.  table_retrieve_batch sets out[i] to
+ * what table_retrieve(T, keys[i]) would return and returns the number of
+ * keys found.  table_insert_batch inserts (keys[i], data[i]) in order,
+ * sets codes[i] (if codes is not NULL) to what table_insert would return,
+ * and returns the number of new keys.  While one key is looked up the home
+ * positions of the next few are prefetched, so on a table much bigger
+ * than the cache the cache misses of several keys overlap.  table_stats
+ * is for the last key.  table_retrieve_batch does not work with
+ * TABLE_INLINE, where a NULL out[i] could be the value 0.
+ */
+int table_retrieve_batch(table_t *, const hashkey_t *keys, int n, data_t *out);
+int table_insert_batch(table_t *, const hashkey_t *keys, const data_t *data, int n, int *codes);
+
 /* Free all information in the table, the table itself, and any additional
  * headers or other supporting data structures.  
  */
@@ -96,12 +264,23 @@ void table_destruct(table_t *);
  */
 int table_stats(table_t *);  
 
+/* Fill in *S for every call since table_construct (a table_rehash keeps
+ * them) and the table as it is now.  While an automatic resize is under
+ * way only the new arrays are scanned.  Returns 1 if the calls and probes
+ * were counted, and 0 if table.c was compiled without TABLE_STATS.
+ */
+int table_get_stats(table_t *T, struct table_stats *S);
+int table_stats_bin(int length);
+int table_stats_bin_min(int bin);
+
 /* This function is for testing purposes only.  Given an index position into
  * the hash table return the value of the key if data is stored in this 
  * index position.  If the index position does not contain data, then the
  * return value must be INT_MAX.  Make the first
  * lines of this function 
  *       assert(0 <= index && index < table_size); 
+ *
+ * Keys in the CUCKOO stash have no index, so peek does not see them.
  */
 hashkey_t table_peek(table_t *T, int index); 
 
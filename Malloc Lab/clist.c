@@ -0,0 +1,246 @@
+/* clist.c
+ * Fall 2022
+ *
+ * Purpose: Lists that threads can share.  See clist.h for when to use the
+ * queue and when to use the locked list.
+ */
+
+#include <stdlib.h>
+#include <assert.h>
+
+#include "datatypes.h"
+#include "clist.h"
+
+/* ----- lock-free queue -----
+ *
+ * This is the bounded ring of Dmitry Vyukov.  enqueue_pos and dequeue_pos
+ * only grow, and position pos uses cell pos & mask.  A thread claims a
+ * position with a compare-and-swap on its counter and then owns the cell
+ * until it publishes the result with a release store to seq, so the
+ * element is never read or written by two threads at once.  The counters
+ * are size_t and wrap far later than any run.
+ */
+
+/* allocates an empty queue that holds up to capacity elements, rounded up
+ * to a power of 2
+ */
+clist_queue_t * clist_queue_construct(int capacity)
+{
+    clist_queue_t *Q;
+    size_t n = 2, i;
+
+    assert(capacity > 0);
+    while (n < (size_t) capacity)
+        n *= 2;
+    Q = (clist_queue_t *) aligned_alloc(_Alignof(clist_queue_t), sizeof(clist_queue_t));
+    assert(Q != NULL);
+    Q->cells = (clist_cell_t *) malloc(n * sizeof(clist_cell_t));
+    assert(Q->cells != NULL);
+    for (i = 0; i < n; i++) {
+        atomic_init(&Q->cells[i].seq, i);
+        Q->cells[i].data_ptr = NULL;
+    }
+    Q->mask = n - 1;
+    atomic_init(&Q->enqueue_pos, 0);
+    atomic_init(&Q->dequeue_pos, 0);
+    return Q;
+}
+
+/* frees the queue and every element still in it */
+void clist_queue_destruct(clist_queue_t *queue_ptr)
+{
+    data_t *elem_ptr;
+
+    assert(queue_ptr != NULL);
+    while ((elem_ptr = clist_queue_pop(queue_ptr)) != NULL)
+        free(elem_ptr);
+    free(queue_ptr->cells);
+    free(queue_ptr);
+}
+
+/* adds elem_ptr at the tail.  Returns 1, or 0 if the queue is full */
+int clist_queue_push(clist_queue_t *queue_ptr, data_t *elem_ptr)
+{
+    clist_cell_t *cell;
+    size_t pos, seq;
+
+    assert(queue_ptr != NULL && elem_ptr != NULL);
+    pos = atomic_load_explicit(&queue_ptr->enqueue_pos, memory_order_relaxed);
+    for (;;) {
+        cell = &queue_ptr->cells[pos & queue_ptr->mask];
+        seq = atomic_load_explicit(&cell->seq, memory_order_acquire);
+        if (seq == pos) {
+            // the cell is free; on failure pos is reloaded and we retry
+            if (atomic_compare_exchange_weak_explicit(&queue_ptr->enqueue_pos,
+                        &pos, pos + 1, memory_order_relaxed, memory_order_relaxed))
+                break;
+        } else if ((ptrdiff_t) (seq - pos) < 0) {
+            return 0;   // the cell still holds the element from a lap ago
+        } else {
+            pos = atomic_load_explicit(&queue_ptr->enqueue_pos, memory_order_relaxed);
+        }
+    }
+    cell->data_ptr = elem_ptr;
+    atomic_store_explicit(&cell->seq, pos + 1, memory_order_release);
+    return 1;
+}
+
+/* removes the element at the head and returns it, or returns NULL if the
+ * queue is empty
+ */
+data_t * clist_queue_pop(clist_queue_t *queue_ptr)
+{
+    clist_cell_t *cell;
+    data_t *elem_ptr;
+    size_t pos, seq;
+
+    assert(queue_ptr != NULL);
+    pos = atomic_load_explicit(&queue_ptr->dequeue_pos, memory_order_relaxed);
+    for (;;) {
+        cell = &queue_ptr->cells[pos & queue_ptr->mask];
+        seq = atomic_load_explicit(&cell->seq, memory_order_acquire);
+        if (seq == pos + 1) {
+            if (atomic_compare_exchange_weak_explicit(&queue_ptr->dequeue_pos,
+                        &pos, pos + 1, memory_order_relaxed, memory_order_relaxed))
+                break;
+        } else if ((ptrdiff_t) (seq - (pos + 1)) < 0) {
+            return NULL;   // no producer has filled this cell yet
+        } else {
+            pos = atomic_load_explicit(&queue_ptr->dequeue_pos, memory_order_relaxed);
+        }
+    }
+    elem_ptr = cell->data_ptr;
+    cell->data_ptr = NULL;
+    // hand the cell to the producer one lap ahead
+    atomic_store_explicit(&cell->seq, pos + queue_ptr->mask + 1, memory_order_release);
+    return elem_ptr;
+}
+
+/* returns the number of elements, which is only a snapshot while other
+ * threads push or pop
+ */
+int clist_queue_size(clist_queue_t *queue_ptr)
+{
+    size_t head, tail;
+
+    assert(queue_ptr != NULL);
+    head = atomic_load_explicit(&queue_ptr->dequeue_pos, memory_order_relaxed);
+    tail = atomic_load_explicit(&queue_ptr->enqueue_pos, memory_order_relaxed);
+    if (tail < head)   // a pop finished between the two loads
+        return 0;
+    return (int) (tail - head);
+}
+
+/* ----- list with hand-over-hand locking -----
+ *
+ * A thread always holds the lock of the node it stands on, and takes the
+ * lock of the next node before it lets go of it.  A node can only be
+ * unlinked by a thread that holds the locks of it and its predecessor, so
+ * the node a walk moves to cannot be freed under it, and since every walk
+ * locks from the head towards the tail there is no deadlock.
+ */
+
+/* allocates an empty list */
+clist_t * clist_construct(void)
+{
+    clist_t *L;
+
+    L = (clist_t *) malloc(sizeof(clist_t));
+    assert(L != NULL);
+    L->head.data_ptr = NULL;
+    L->head.next = NULL;
+    pthread_mutex_init(&L->head.lock, NULL);
+    atomic_init(&L->size, 0);
+    return L;
+}
+
+/* frees the list and every element in it */
+void clist_destruct(clist_t *list_ptr)
+{
+    clist_node_t *node, *next;
+
+    assert(list_ptr != NULL);
+    for (node = list_ptr->head.next; node != NULL; node = next) {
+        next = node->next;
+        free(node->data_ptr);
+        pthread_mutex_destroy(&node->lock);
+        free(node);
+    }
+    pthread_mutex_destroy(&list_ptr->head.lock);
+    free(list_ptr);
+}
+
+/* walks from the head to the node in front of position pos, or to the last
+ * node if the list is shorter, and returns it locked
+ */
+static clist_node_t *clist_lock_before(clist_t *L, int pos)
+{
+    clist_node_t *node = &L->head, *next;
+
+    pthread_mutex_lock(&node->lock);
+    while (pos-- > 0 && (next = node->next) != NULL) {
+        pthread_mutex_lock(&next->lock);
+        pthread_mutex_unlock(&node->lock);
+        node = next;
+    }
+    return node;
+}
+
+/* inserts elem_ptr at position pos, or at the tail if the list is
+ * shorter than pos
+ */
+void clist_insert_at(clist_t *list_ptr, data_t *elem_ptr, int pos)
+{
+    clist_node_t *new, *prev;
+
+    assert(list_ptr != NULL && elem_ptr != NULL && pos >= 0);
+    new = (clist_node_t *) malloc(sizeof(clist_node_t));
+    assert(new != NULL);
+    new->data_ptr = elem_ptr;
+    pthread_mutex_init(&new->lock, NULL);
+
+    prev = clist_lock_before(list_ptr, pos);
+    new->next = prev->next;
+    prev->next = new;
+    atomic_fetch_add_explicit(&list_ptr->size, 1, memory_order_relaxed);
+    pthread_mutex_unlock(&prev->lock);
+}
+
+/* removes the element at position pos and returns it, or returns NULL if
+ * the list has no element at pos
+ */
+data_t * clist_remove_at(clist_t *list_ptr, int pos)
+{
+    clist_node_t *prev, *node;
+    data_t *elem_ptr;
+
+    assert(list_ptr != NULL && pos >= 0);
+    prev = clist_lock_before(list_ptr, pos);
+    node = prev->next;
+    if (node == NULL) {
+        pthread_mutex_unlock(&prev->lock);
+        return NULL;
+    }
+    // wait for a thread that is still on node to move past it
+    pthread_mutex_lock(&node->lock);
+    prev->next = node->next;
+    atomic_fetch_sub_explicit(&list_ptr->size, 1, memory_order_relaxed);
+    pthread_mutex_unlock(&node->lock);
+    pthread_mutex_unlock(&prev->lock);
+
+    elem_ptr = node->data_ptr;
+    pthread_mutex_destroy(&node->lock);
+    free(node);
+    return elem_ptr;
+}
+
+/* returns the number of elements, which is only a snapshot while other
+ * threads insert or remove
+ */
+int clist_size(clist_t *list_ptr)
+{
+    assert(list_ptr != NULL);
+    return atomic_load_explicit(&list_ptr->size, memory_order_relaxed);
+}
+
+/* vi:set ts=8 sts=4 sw=4 et: */
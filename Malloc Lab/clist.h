@@ -0,0 +1,118 @@
+/* clist.h
+ * Fall 2022
+ *
+ * Public functions for lists that are shared by threads
+ *
+ * Nothing in list.c is synchronized, so threads that share a list_t have
+ * to hold one mutex around every call, and a pipeline of producer and
+ * consumer threads then runs one operation at a time.  This file has two
+ * lists that threads can call at the same time:
+ *
+ * clist_queue_t is a bounded first-in first-out queue for many producers
+ * and many consumers.  Push and pop take no locks; each claims a cell of
+ * a ring with one compare-and-swap on the tail or head counter, so
+ * producers and consumers only contend with their own kind.  A full queue
+ * makes push return 0 and an empty one makes pop return NULL, and it
+ * is up to the caller to retry or wait.
+ *
+ * clist_t is a list with positional insert and remove.  Every node has
+ * its own mutex and a thread walks the list with hand-over-hand locking:
+ * it locks the next node before it unlocks the current one.  Threads that
+ * work at different positions only wait for each other while one passes
+ * the other, instead of for the whole operation.
+ *
+ * Neither list calls Mem_alloc, which is not thread safe.  Nodes and the
+ * ring come from malloc.
+ */
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stddef.h>
+
+/* ----- lock-free queue ----- */
+
+/* seq tells whose turn a cell is: a producer may fill the cell at
+ * position pos when seq == pos, and a consumer may empty it when
+ * seq == pos + 1
+ */
+typedef struct clist_cell_tag {
+    atomic_size_t seq;
+    data_t *data_ptr;
+} clist_cell_t;
+
+/* the two counters are on separate cache lines so producers and consumers
+ * do not invalidate each other's line on every operation
+ */
+typedef struct clist_queue_tag {
+    // private members for clist.c only
+    clist_cell_t *cells;
+    size_t mask;
+    _Alignas(64) atomic_size_t enqueue_pos;
+    _Alignas(64) atomic_size_t dequeue_pos;
+} clist_queue_t;
+
+/* allocates an empty queue that holds up to capacity elements.  The
+ * capacity is rounded up to a power of 2.
+ */
+clist_queue_t * clist_queue_construct(int capacity);
+
+/* frees the queue and every element still in it.  No other thread may be
+ * using the queue.
+ */
+void clist_queue_destruct(clist_queue_t *queue_ptr);
+
+/* adds elem_ptr at the tail.  Returns 1, or 0 if the queue is full */
+int clist_queue_push(clist_queue_t *queue_ptr, data_t *elem_ptr);
+
+/* removes the element at the head and returns it, or returns NULL if the
+ * queue is empty
+ */
+data_t * clist_queue_pop(clist_queue_t *queue_ptr);
+
+/* returns the number of elements.  While other threads push or pop it is
+ * only a snapshot.
+ */
+int clist_queue_size(clist_queue_t *queue_ptr);
+
+/* ----- list with hand-over-hand locking ----- */
+
+typedef struct clist_node_tag {
+    // private members for clist.c only
+    data_t *data_ptr;
+    struct clist_node_tag *next;
+    pthread_mutex_t lock;
+} clist_node_t;
+
+/* head is a sentinel without data.  Its lock guards head.next, so an
+ * insert or remove at position 0 takes the same path as any other.
+ */
+typedef struct clist_tag {
+    // private members for clist.c only
+    clist_node_t head;
+    atomic_int size;
+} clist_t;
+
+/* allocates an empty list */
+clist_t * clist_construct(void);
+
+/* frees the list and every element in it.  No other thread may be using
+ * the list.
+ */
+void clist_destruct(clist_t *list_ptr);
+
+/* inserts elem_ptr so that it ends up at position pos, or at the tail if
+ * the list has fewer than pos elements when the walk gets there
+ */
+void clist_insert_at(clist_t *list_ptr, data_t *elem_ptr, int pos);
+
+/* removes the element at position pos and returns it, or returns NULL if
+ * the list has no element at pos when the walk gets there
+ */
+data_t * clist_remove_at(clist_t *list_ptr, int pos);
+
+/* returns the number of elements.  While other threads insert or remove
+ * it is only a snapshot.
+ */
+int clist_size(clist_t *list_ptr);
+
+/* vi:set ts=8 sts=4 sw=4 et: */
@@ -0,0 +1,92 @@
+/* ilist.c
+ * Fall 2022
+ *
+ * Purpose: Intrusive two-way linked list.  See ilist.h for how objects
+ * embed their links.
+ */
+
+#include <stdlib.h>
+#include <assert.h>
+
+#include "ilist.h"
+
+/* makes list_ptr an empty list */
+void ilist_init(ilist_t *list_ptr)
+{
+    assert(list_ptr != NULL);
+    list_ptr->sentinel.prev = &list_ptr->sentinel;
+    list_ptr->sentinel.next = &list_ptr->sentinel;
+    list_ptr->size = 0;
+}
+
+/* returns the first link, or NULL if the list is empty */
+ilist_link_t * ilist_front(ilist_t *list_ptr)
+{
+    assert(list_ptr != NULL);
+    if (list_ptr->size == 0)
+        return NULL;
+    return list_ptr->sentinel.next;
+}
+
+/* returns the last link, or NULL if the list is empty */
+ilist_link_t * ilist_back(ilist_t *list_ptr)
+{
+    assert(list_ptr != NULL);
+    if (list_ptr->size == 0)
+        return NULL;
+    return list_ptr->sentinel.prev;
+}
+
+/* returns the link after link_ptr, or NULL if link_ptr is the last one */
+ilist_link_t * ilist_next(ilist_t *list_ptr, ilist_link_t *link_ptr)
+{
+    assert(list_ptr != NULL && link_ptr != NULL);
+    if (link_ptr->next == &list_ptr->sentinel)
+        return NULL;
+    return link_ptr->next;
+}
+
+/* links link_ptr in front of idx_ptr, or at the tail if idx_ptr is NULL */
+void ilist_insert(ilist_t *list_ptr, ilist_link_t *link_ptr, ilist_link_t *idx_ptr)
+{
+    assert(list_ptr != NULL && link_ptr != NULL);
+    if (idx_ptr == NULL)
+        idx_ptr = &list_ptr->sentinel;
+    link_ptr->next = idx_ptr;
+    link_ptr->prev = idx_ptr->prev;
+    idx_ptr->prev->next = link_ptr;
+    idx_ptr->prev = link_ptr;
+    list_ptr->size++;
+}
+
+/* unlinks link_ptr, or the first link if link_ptr is NULL, and returns it.
+ * The links of the removed object are set to NULL so that a stale use
+ * fails quickly.
+ */
+ilist_link_t * ilist_remove(ilist_t *list_ptr, ilist_link_t *link_ptr)
+{
+    assert(list_ptr != NULL);
+    if (list_ptr->size == 0) {
+        assert(link_ptr == NULL);
+        return NULL;
+    }
+    if (link_ptr == NULL)
+        link_ptr = list_ptr->sentinel.next;
+    assert(link_ptr != &list_ptr->sentinel);
+    link_ptr->prev->next = link_ptr->next;
+    link_ptr->next->prev = link_ptr->prev;
+    link_ptr->prev = NULL;
+    link_ptr->next = NULL;
+    list_ptr->size--;
+    return link_ptr;
+}
+
+/* returns the number of links on the list */
+int ilist_size(ilist_t *list_ptr)
+{
+    assert(list_ptr != NULL);
+    assert(list_ptr->size >= 0);
+    return list_ptr->size;
+}
+
+/* vi:set ts=8 sts=4 sw=4 et: */
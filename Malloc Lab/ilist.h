@@ -0,0 +1,71 @@
+/* ilist.h
+ * Fall 2022
+ *
+ * Public functions for an intrusive two-way linked list
+ *
+ * The list in list.c allocates a node for every element it holds.  An
+ * intrusive list instead links objects through an ilist_link_t that the
+ * caller embeds in each object, so inserting and removing never allocate
+ * or free memory.  ilist_entry recovers the object from a pointer to its
+ * link:
+ *
+ *     typedef struct { int size; ilist_link_t link; int data[]; } block_t;
+ *
+ *     ilist_insert(&blocks, &b->link, NULL);
+ *     block_t *b = ilist_entry(ilist_front(&blocks), block_t, link);
+ *
+ * An object can be on one list per embedded link at a time.  The list
+ * never frees objects; that is up to the caller.
+ */
+
+#include <stddef.h>    // offsetof
+
+typedef struct ilist_link_tag {
+    // private members for ilist.c only
+    struct ilist_link_tag *prev;
+    struct ilist_link_tag *next;
+} ilist_link_t;
+
+/* The list is circular through the sentinel link in the header, so no
+ * insert or remove has a special case for an empty list or an end.
+ */
+typedef struct ilist_tag {
+    // private members for ilist.c only
+    ilist_link_t sentinel;
+    int size;
+} ilist_t;
+
+/* returns a pointer to the object of type type whose member named member
+ * is the link at link_ptr
+ */
+#define ilist_entry(link_ptr, type, member) \
+    ((type *) ((char *) (link_ptr) - offsetof(type, member)))
+
+/* makes list_ptr an empty list.  The header can be on the stack or inside
+ * another object; there is nothing to clean up.
+ */
+void ilist_init(ilist_t *list_ptr);
+
+/* returns the first link, or NULL if the list is empty */
+ilist_link_t * ilist_front(ilist_t *list_ptr);
+
+/* returns the last link, or NULL if the list is empty */
+ilist_link_t * ilist_back(ilist_t *list_ptr);
+
+/* returns the link after link_ptr, or NULL if link_ptr is the last one */
+ilist_link_t * ilist_next(ilist_t *list_ptr, ilist_link_t *link_ptr);
+
+/* links link_ptr into the list in front of idx_ptr, or at the tail if
+ * idx_ptr is NULL.  link_ptr must not be on a list already.
+ */
+void ilist_insert(ilist_t *list_ptr, ilist_link_t *link_ptr, ilist_link_t *idx_ptr);
+
+/* unlinks link_ptr from the list and returns it.  If link_ptr is NULL the
+ * first link is removed.  Returns NULL if the list is empty.
+ */
+ilist_link_t * ilist_remove(ilist_t *list_ptr, ilist_link_t *link_ptr);
+
+/* returns the number of links on the list */
+int ilist_size(ilist_t *list_ptr);
+
+/* vi:set ts=8 sts=4 sw=4 et: */
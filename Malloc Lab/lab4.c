@@ -13,6 +13,7 @@
  *
  * -f best|first        search policy to find memory block (first by default)
  * -c                   turn on coalescing (off by default)
+ * -H                   take heap pages from huge page reservations (off by default)
  *
  * General options for all test drivers
  * -s 19283  random number generator seed
@@ -32,6 +33,71 @@
  * additional options.
  * -e        run equilibrium test driver
  *
+ * The compaction driver allocates relocatable blocks with Mem_halloc, frees
+ * about half of them, and compares the heap before and after Mem_compact.
+ * It uses the -w, -a, and -r options of the equilibrium driver.
+ * -k        run compaction test driver
+ *
+ * The lifetime driver mixes long-lived arrays that are kept until the end
+ * with a window of short-lived arrays that churn, and reports the peak heap
+ * size.  With tagged, allocations go through Mem_alloc_tagged so the
+ * allocator can learn to keep the two kinds in separate arenas, and with
+ * site the sites are the return addresses that MEM_ALLOC_SITE finds.  It
+ * uses the -w, -t, -a, and -r options of the equilibrium driver.
+ * -l plain|tagged|site  run lifetime driver with Mem_alloc, Mem_alloc_tagged,
+ *           or MEM_ALLOC_SITE
+ *
+ * The batch driver times Mem_alloc_batch and Mem_free_batch against loops of
+ * Mem_alloc and Mem_free.  Each round allocates -w arrays of -a integers and
+ * frees them in a random order; there are -t/-w rounds.
+ * -b        run batch driver
+ *
+ * The large heap driver checks that sizes past 2 GiB are handled.  It
+ * allocates one block larger than 2 GiB and then blocks of 256 MiB until
+ * the total reaches the requested size, checks that impossible requests
+ * fail cleanly, and frees everything.
+ * -g 3      run large heap driver with 3 GiB total
+ *
+ * The huge page driver fills and scans arrays that total the requested
+ * number of MiB, once with pages from sbrk and once with pages from huge
+ * page reservations, and reports the time for each.  Each array is 1 MiB.
+ * The scans read the arrays in order and at random places so that the
+ * cost of TLB misses shows up.  Both sets of arrays are kept until the end
+ * so the second pass cannot reuse the pages of the first.
+ * -S 256    run huge page driver with 256 MiB in each pass
+ *
+ * The list driver times walking a list with list_iter_next and searching
+ * it with list_elem_find for lists of 10^3 elements up to 10^N elements.
+ * lab4 uses the node per element list in list.c, and lab4u is the same
+ * program built with the unrolled list in ulist.c, so running both
+ * compares the two.  Each size is repeated until 10^N elements have been
+ * visited.
+ * -L 7      run list driver up to 10^7 elements
+ *
+ * The intrusive list driver keeps -w arrays from Mem_alloc in a queue and
+ * cycles them -t times, taking one from the front and putting it back at
+ * the tail.  It runs once with the list ADT, which allocates a node for
+ * each array, and once with ilist, where the link is stored in the array's
+ * own block, and reports the time per insert or remove for each.
+ * -i        run intrusive list driver
+ *
+ * The sort driver builds lists of 10^4 up to 10^N random integers and
+ * times sort with SORT_MERGE and with SORT_MERGE_PARALLEL.  Building the
+ * same sorted list with list_insert_sorted takes O(n^2) time, and each
+ * insert also validates the whole list, so it is only timed for the list
+ * of 10^4 elements.
+ * -O 7      run sort driver up to 10^7 elements
+ *
+ * The concurrent driver passes -t items from producer threads to consumer
+ * threads, once through a list_t behind one mutex and once through the
+ * lock-free clist_queue_t, with 1, 2, 4, ... up to N producers and as
+ * many consumers, and reports the throughput of each.  Every consumer
+ * checks that the items of each producer reach it in order, and at the
+ * end every item must have arrived exactly once.  It then runs a stress
+ * test where N threads insert and remove at random positions of a clist_t
+ * that starts with -w items, again compared with a list_t behind a mutex.
+ * -C 4      run concurrent list driver with up to 4 producers
+ *
  * To test the equilibrium driver with the system malloc/free isntead
  * of your implementation of a heap use the option
  * -d        Use system malloc/free to verify equilibrium dirver and list ADT
@@ -52,14 +118,19 @@
 #include <ctype.h>
 //#include <malloc.h>    // OSX users may need to comment out this include
 #include <time.h>
+#include <pthread.h>
+#include <sched.h>
 
 #include "datatypes.h"
 #include "list.h"
 #include "mem.h"
+#include "ilist.h"
+#include "clist.h"
 
 // Global variables first defined in mem.h 
 int SearchPolicy = FIRST_FIT;
 int Coalescing = FALSE;
+int HugePages = FALSE;
 
 // structure for equilibrium driver parameters 
 typedef struct {
@@ -72,11 +143,29 @@ typedef struct {
     int RangeInts;
     int SysMalloc;
     int UnitDriver;
+    int CompactTest;
+    int LifetimeTest;
+    int BatchTest;
+    int LargeHeapGiB;
+    int HugeScanMiB;
+    int ListMaxPow;
+    int IntrusiveTest;
+    int SortMaxPow;
+    int ConcurrentThreads;
 } driver_params;
 
 // prototypes for functions in this file only 
 void getCommandLine(int argc, char **argv, driver_params *ep);
 void equilibriumDriver(driver_params *ep);
+void compactionDriver(driver_params *ep);
+void lifetimeDriver(driver_params *ep);
+void batchDriver(driver_params *ep);
+void largeHeapDriver(driver_params *ep);
+void hugePageDriver(driver_params *ep);
+void listDriver(driver_params *ep);
+void intrusiveDriver(driver_params *ep);
+void sortDriver(driver_params *ep);
+void concurrentDriver(driver_params *ep);
 
 int main(int argc, char **argv)
 {
@@ -98,6 +187,7 @@ int main(int argc, char **argv)
         fprintf(stderr, "Error specify coalescing policy\n");
         exit(1);
     }
+    if (HugePages == TRUE) printf("Heap pages from huge page reservations\n");
 
     if (dprms.UnitDriver == 0)
     {
@@ -271,6 +361,42 @@ int main(int argc, char **argv)
     //   -- show that rover spreads allocatins in list and does not cluster
     //      fragments at head of the free list
 
+    // test that handle blocks can be moved to remove fragmentation
+    if (dprms.CompactTest)
+        compactionDriver(&dprms);
+
+    // compare peak heap with and without lifetime segregation
+    if (dprms.LifetimeTest)
+        lifetimeDriver(&dprms);
+
+    // compare batch calls with loops of single calls
+    if (dprms.BatchTest)
+        batchDriver(&dprms);
+
+    // allocate more than an int can count
+    if (dprms.LargeHeapGiB > 0)
+        largeHeapDriver(&dprms);
+
+    // compare 4 KiB pages with huge pages for array scans
+    if (dprms.HugeScanMiB > 0)
+        hugePageDriver(&dprms);
+
+    // walk and search lists of growing size
+    if (dprms.ListMaxPow > 0)
+        listDriver(&dprms);
+
+    // compare the list ADT with a list that needs no nodes
+    if (dprms.IntrusiveTest)
+        intrusiveDriver(&dprms);
+
+    // compare sort with building a sorted list one element at a time
+    if (dprms.SortMaxPow > 0)
+        sortDriver(&dprms);
+
+    // compare a list behind one mutex with lists that threads can share
+    if (dprms.ConcurrentThreads > 0)
+        concurrentDriver(&dprms);
+
     // test for performance in equilibrium 
     if (dprms.EquilibriumTest)
         equilibriumDriver(&dprms);
@@ -322,7 +448,6 @@ void equilibriumDriver(driver_params *ep)
     int size;
     int pos;
     ListPtr mem_list;
-    IteratorPtr idx_ptr;
     clock_t start, end;
 
     // print parameters for this test run 
@@ -336,7 +461,8 @@ void equilibriumDriver(driver_params *ep)
     printf("  Average array size: %d\n", ep->AvgNumInts);
     printf("  Range for average array size: %d\n", ep->RangeInts);
 
-    mem_list = list_construct(NULL);
+    // indexed so that removing the block at a random position is O(log n)
+    mem_list = list_construct_indexed(NULL);
     // the size of the integer array is uniformly distributed in the range
     // [avg-range, avg+range]
 
@@ -360,7 +486,7 @@ void equilibriumDriver(driver_params *ep)
         ptr[0] = -size;
         for (index = 1; index < size; index++)
             ptr[index] = -index;   // same as *(ptr+index)=index 
-        list_insert(mem_list, (data_t *) ptr, NULL);
+        list_insert_at(mem_list, (data_t *) ptr, list_size(mem_list));
         ptr = NULL;
     }
     printf("After warmup\n");
@@ -392,14 +518,11 @@ void equilibriumDriver(driver_params *ep)
             ptr[0] = -size;
             for (index = 1; index < size; index++)
                 ptr[index] = -index;
-            list_insert(mem_list, (data_t *) ptr, NULL);
+            list_insert_at(mem_list, (data_t *) ptr, list_size(mem_list));
             ptr = NULL;
         } else if (list_size(mem_list) > 0) {
             pos = (int) (drand48() * list_size(mem_list));
-            idx_ptr = list_iter_front(mem_list);
-            for (index = 0; index < pos; index++)
-                idx_ptr = list_iter_next(idx_ptr);
-            ptr = (int *) list_remove(mem_list, idx_ptr);
+            ptr = (int *) list_remove_at(mem_list, pos);
             assert(ptr != NULL);
             size = -ptr[0];
             if (ep->Verbose) {
@@ -461,6 +584,1025 @@ void equilibriumDriver(driver_params *ep)
     printf("----- End of equilibrium test -----\n\n");
 }
 
+/* ----- compactionDriver -----
+ *
+ * Allocates WarmUp integer arrays with Mem_halloc using the same size
+ * distribution as the equilibrium driver.  Every 16th array stays locked for
+ * the whole test so that Mem_compact has to work around pinned blocks.
+ * About half of the other arrays are freed at random, which leaves the free
+ * list full of holes.  Mem_stats is called before and after Mem_compact to
+ * show the free list collapse and the heap shrink, and then every array is
+ * checked to verify that moving it did not change its contents.
+ */
+void compactionDriver(driver_params *ep)
+{
+    int i, index;
+    int range_num_ints;
+    int min_num_ints;
+    int *ptr;
+    int size;
+    int num_live = 0;
+    mhandle_t *handles;
+    clock_t start, end;
+
+    printf("\nCompaction test driver using Mem_halloc and Mem_compact\n");
+    printf("  Allocations: %d\n", ep->WarmUp);
+    printf("  Average array size: %d\n", ep->AvgNumInts);
+    printf("  Range for average array size: %d\n", ep->RangeInts);
+
+    range_num_ints = 2 * ep->RangeInts + 1;
+    min_num_ints = ep->AvgNumInts - ep->RangeInts;
+    if (min_num_ints < 1 || ep->AvgNumInts < 1 || ep->RangeInts < 0) {
+        printf("The average array size must be positive and greater than the range\n");
+        exit(1);
+    }
+    handles = (mhandle_t *) malloc(ep->WarmUp * sizeof(mhandle_t));
+    assert(handles != NULL);
+
+    for (i = 0; i < ep->WarmUp; i++) {
+        size = ((int) (drand48() * range_num_ints)) + min_num_ints;
+        handles[i] = Mem_halloc(size * sizeof(int));
+        assert(handles[i] != MEM_NULL_HANDLE);
+        ptr = (int *) Mem_lock(handles[i]);
+        ptr[0] = -size;
+        for (index = 1; index < size; index++)
+            ptr[index] = -index;
+        if (i % 16 != 0)     // every 16th array stays pinned
+            Mem_unlock(handles[i]);
+        ptr = NULL;
+    }
+    for (i = 0; i < ep->WarmUp; i++) {
+        if (i % 16 != 0 && drand48() < 0.5) {
+            Mem_hfree(handles[i]);
+            handles[i] = MEM_NULL_HANDLE;
+        } else {
+            num_live++;
+        }
+    }
+    printf("Before compaction with %d live arrays\n", num_live);
+    Mem_stats();
+    if (ep->Verbose) Mem_print();
+
+    start = clock();
+    Mem_compact();
+    end = clock();
+    printf("After compaction, time=%g\n",
+            1000*((double)(end-start))/CLOCKS_PER_SEC);
+    Mem_stats();
+    if (ep->Verbose) Mem_print();
+
+    // verify contents survived the move, then free everything
+    for (i = 0; i < ep->WarmUp; i++) {
+        if (handles[i] == MEM_NULL_HANDLE)
+            continue;
+        ptr = (int *) Mem_lock(handles[i]);
+        size = -ptr[0];
+        assert(min_num_ints <= size && size <= ep->AvgNumInts+ep->RangeInts);
+        for (index = 1; index < size; index++)
+            assert(ptr[index] == -index);
+        Mem_unlock(handles[i]);
+        if (i % 16 == 0)
+            Mem_unlock(handles[i]);
+        Mem_hfree(handles[i]);
+        ptr = NULL;
+    }
+    free(handles);
+    printf("After cleanup\n");
+    Mem_stats();
+    if (ep->Verbose) Mem_print();
+    printf("----- End of compaction test -----\n\n");
+}
+/* ----- lifetimeDriver -----
+ *
+ * Each trial allocates one short-lived array and frees the array allocated
+ * LIFETIME_WINDOW trials earlier, so short-lived arrays churn in a sliding
+ * window.  Spread evenly over the trials, WarmUp long-lived arrays are
+ * allocated and kept until the end.  With plain allocation the long-lived
+ * arrays land in the holes left by the churn and pin pages; with tagged
+ * allocation the short-lived site is moved to its own arena once the
+ * allocator has seen its lifetimes.
+ */
+#define LIFETIME_WINDOW 64
+#define SHORT_SITE 1
+#define LONG_SITE 2
+
+/* for -l site, one function for each kind of array, each called from one
+ * place, so MEM_ALLOC_SITE sees two sites
+ */
+static __attribute__((noinline)) int *allocShortLived(int size)
+{
+    return (int *) MEM_ALLOC_SITE(size * sizeof(int));
+}
+
+static __attribute__((noinline)) int *allocLongLived(int size)
+{
+    return (int *) MEM_ALLOC_SITE(size * sizeof(int));
+}
+
+void lifetimeDriver(driver_params *ep)
+{
+    int i, index;
+    int range_num_ints;
+    int min_num_ints;
+    int *ptr;
+    int size;
+    int slot = 0;
+    int num_long = 0;
+    int long_every;
+    int *window[LIFETIME_WINDOW] = {NULL};
+    int **long_lived;
+    int tagged = ep->LifetimeTest == 2;
+    int site = ep->LifetimeTest == 3;
+    clock_t start, end;
+
+    printf("\nLifetime test driver using %s\n",
+            site ? "MEM_ALLOC_SITE" : tagged ? "Mem_alloc_tagged" : "Mem_alloc");
+    printf("  Trials: %d\n", ep->Trials);
+    printf("  Long-lived allocations: %d\n", ep->WarmUp);
+    printf("  Average array size: %d\n", ep->AvgNumInts);
+    printf("  Range for average array size: %d\n", ep->RangeInts);
+
+    range_num_ints = 2 * ep->RangeInts + 1;
+    min_num_ints = ep->AvgNumInts - ep->RangeInts;
+    if (min_num_ints < 1 || ep->AvgNumInts < 1 || ep->RangeInts < 0) {
+        printf("The average array size must be positive and greater than the range\n");
+        exit(1);
+    }
+    if (ep->WarmUp < 1 || ep->Trials < ep->WarmUp) {
+        printf("The number of trials must be at least the number of long-lived allocations\n");
+        exit(1);
+    }
+    long_every = ep->Trials / ep->WarmUp;
+    long_lived = (int **) malloc(ep->WarmUp * sizeof(int *));
+    assert(long_lived != NULL);
+
+    start = clock();
+    for (i = 0; i < ep->Trials; i++) {
+        size = ((int) (drand48() * range_num_ints)) + min_num_ints;
+        if (site)
+            ptr = allocShortLived(size);
+        else if (tagged)
+            ptr = (int *) Mem_alloc_tagged(size * sizeof(int), SHORT_SITE);
+        else
+            ptr = (int *) Mem_alloc(size * sizeof(int));
+        assert(ptr != NULL);
+        ptr[0] = -size;
+        for (index = 1; index < size; index++)
+            ptr[index] = -index;
+        if (window[slot] != NULL) {   // oldest short-lived array dies
+            size = -window[slot][0];
+            for (index = 1; index < size; index++)
+                assert(window[slot][index] == -index);
+            Mem_free(window[slot]);
+        }
+        window[slot] = ptr;
+        slot = (slot + 1) % LIFETIME_WINDOW;
+
+        if (i % long_every == 0 && num_long < ep->WarmUp) {
+            size = ((int) (drand48() * range_num_ints)) + min_num_ints;
+            if (site)
+                ptr = allocLongLived(size);
+            else if (tagged)
+                ptr = (int *) Mem_alloc_tagged(size * sizeof(int), LONG_SITE);
+            else
+                ptr = (int *) Mem_alloc(size * sizeof(int));
+            assert(ptr != NULL);
+            ptr[0] = -size;
+            for (index = 1; index < size; index++)
+                ptr[index] = -index;
+            long_lived[num_long++] = ptr;
+        }
+        ptr = NULL;
+    }
+    end = clock();
+    printf("After exercise, time=%g\n",
+            1000*((double)(end-start))/CLOCKS_PER_SEC);
+    Mem_stats();
+    if (ep->Verbose) Mem_print();
+
+    for (i = 0; i < LIFETIME_WINDOW; i++)
+        if (window[i] != NULL)
+            Mem_free(window[i]);
+    for (i = 0; i < num_long; i++) {
+        size = -long_lived[i][0];
+        assert(min_num_ints <= size && size <= ep->AvgNumInts+ep->RangeInts);
+        for (index = 1; index < size; index++)
+            assert(long_lived[i][index] == -index);
+        Mem_free(long_lived[i]);
+    }
+    free(long_lived);
+    printf("After cleanup\n");
+    Mem_stats();
+    if (ep->Verbose) Mem_print();
+    printf("----- End of lifetime test -----\n\n");
+}
+/* ----- batchDriver -----
+ *
+ * Each round allocates WarmUp arrays of AvgNumInts integers, writes the
+ * first and last integer of each, and frees them in a random order.  The
+ * same rounds are run with a loop of Mem_alloc/Mem_free calls and with one
+ * Mem_alloc_batch/Mem_free_batch call each, and the times are compared.
+ * The per-call loop runs first so both versions see a heap that has
+ * already grown to the size of one round.
+ */
+void batchDriver(driver_params *ep)
+{
+    int i, j, round;
+    int rounds;
+    int n = ep->WarmUp;
+    int nbytes = ep->AvgNumInts * sizeof(int);
+    int *order;
+    void **ptrs, **shuffled;
+    int *ptr;
+    clock_t start;
+    double single_time = 0.0, batch_time = 0.0;
+
+    if (n < 1 || ep->AvgNumInts < 1) {
+        printf("The batch driver needs positive -w and -a\n");
+        exit(1);
+    }
+    rounds = ep->Trials / n;
+    if (rounds < 1)
+        rounds = 1;
+    printf("\nBatch test driver\n");
+    printf("  Rounds: %d\n", rounds);
+    printf("  Blocks per round: %d\n", n);
+    printf("  Block size: %d bytes\n", nbytes);
+
+    ptrs = (void **) malloc(n * sizeof(void *));
+    shuffled = (void **) malloc(n * sizeof(void *));
+    order = (int *) malloc(n * sizeof(int));
+    assert(ptrs != NULL && shuffled != NULL && order != NULL);
+
+    for (round = 0; round < 2*rounds; round++) {
+        int batch = round >= rounds;
+        // a random order for the frees, the same kind for both versions
+        for (i = 0; i < n; i++)
+            order[i] = i;
+        for (i = 0; i < n; i++) {
+            j = (int) (drand48() * (n - i)) + i;
+            int temp = order[i]; order[i] = order[j]; order[j] = temp;
+        }
+
+        start = clock();
+        if (batch) {
+            j = Mem_alloc_batch(nbytes, n, ptrs);
+            assert(j == n);
+        } else {
+            for (i = 0; i < n; i++) {
+                ptrs[i] = Mem_alloc(nbytes);
+                assert(ptrs[i] != NULL);
+            }
+        }
+        for (i = 0; i < n; i++) {
+            ptr = (int *) ptrs[i];
+            ptr[0] = i;
+            ptr[ep->AvgNumInts - 1] = -i;
+        }
+        for (i = 0; i < n; i++) {
+            ptr = (int *) ptrs[order[i]];
+            assert(ptr[0] == order[i] && ptr[ep->AvgNumInts - 1] == -order[i]);
+            shuffled[i] = ptr;
+        }
+        if (batch) {
+            Mem_free_batch(shuffled, n);
+        } else {
+            for (i = 0; i < n; i++)
+                Mem_free(shuffled[i]);
+        }
+        if (batch)
+            batch_time += (double) (clock() - start);
+        else
+            single_time += (double) (clock() - start);
+    }
+    printf("Mem_alloc/Mem_free loops, time=%g\n",
+            1000*single_time/CLOCKS_PER_SEC);
+    printf("Mem_alloc_batch/Mem_free_batch, time=%g\n",
+            1000*batch_time/CLOCKS_PER_SEC);
+    Mem_stats();
+    if (ep->Verbose) Mem_print();
+    free(ptrs);
+    free(shuffled);
+    free(order);
+    printf("----- End of batch test -----\n\n");
+}
+/* ----- largeHeapDriver -----
+ *
+ * The first block is 2 GiB plus one page so that its size, its unit count
+ * in bytes, and the heap size all pass INT_MAX.  The rest of the total is
+ * allocated in 256 MiB blocks.  One int is written every MiB of each block
+ * (and at the very end) to show the whole block is addressable without
+ * touching every page, and the values are checked before the blocks are
+ * freed.
+ */
+#define GIB ((size_t) 1 << 30)
+#define MIB ((size_t) 1 << 20)
+void largeHeapDriver(driver_params *ep)
+{
+    size_t total = (size_t) ep->LargeHeapGiB * GIB;
+    size_t allocated = 0;
+    size_t nbytes, offset;
+    int num_blocks = 0;
+    int max_blocks;
+    int i;
+    char **blocks;
+    size_t *sizes;
+    clock_t start, end;
+
+    printf("\nLarge heap test driver\n");
+    printf("  Total to allocate: %zu bytes\n", total);
+
+    // requests that cannot be described in units must fail, not wrap
+    assert(Mem_alloc((size_t) -1) == NULL);
+    assert(Mem_alloc((size_t) -1 - PAGESIZE) == NULL);
+
+    max_blocks = (int) (total / (256*MIB)) + 2;
+    blocks = (char **) malloc(max_blocks * sizeof(char *));
+    sizes = (size_t *) malloc(max_blocks * sizeof(size_t));
+    assert(blocks != NULL && sizes != NULL);
+
+    start = clock();
+    nbytes = 2*GIB + PAGESIZE;
+    while (allocated < total && num_blocks < max_blocks) {
+        blocks[num_blocks] = (char *) Mem_alloc(nbytes);
+        if (blocks[num_blocks] == NULL) {
+            printf("Mem_alloc of %zu bytes failed after %zu bytes\n",
+                    nbytes, allocated);
+            break;
+        }
+        sizes[num_blocks] = nbytes;
+        for (offset = 0; offset < nbytes; offset += MIB)
+            *(int *) (blocks[num_blocks] + offset) = (int) (offset / MIB) + num_blocks;
+        *(int *) (blocks[num_blocks] + nbytes - sizeof(int)) = -num_blocks;
+        allocated += nbytes;
+        num_blocks++;
+        nbytes = 256*MIB;
+    }
+    end = clock();
+    printf("Allocated %d blocks with %zu bytes, time=%g\n", num_blocks,
+            allocated, 1000*((double)(end-start))/CLOCKS_PER_SEC);
+    Mem_stats();
+
+    for (i = 0; i < num_blocks; i++) {
+        for (offset = 0; offset < sizes[i]; offset += MIB)
+            assert(*(int *) (blocks[i] + offset) == (int) (offset / MIB) + i);
+        assert(*(int *) (blocks[i] + sizes[i] - sizeof(int)) == -i);
+        Mem_free(blocks[i]);
+    }
+    free(blocks);
+    free(sizes);
+    printf("After cleanup\n");
+    Mem_stats();
+    if (ep->Verbose) Mem_print();
+    printf("----- End of large heap test -----\n\n");
+}
+
+/* ----- hugePageScan -----
+ *
+ * allocates 1 MiB arrays until they hold bytes bytes, then times filling
+ * them, summing them in order, and summing as many integers again from
+ * random places.  The random places come from a xorshift generator, which
+ * is cheap enough that the time is spent on the reads.  The arrays are
+ * returned in *arrays so the caller decides when to free them.
+ */
+#define HUGE_SCAN_INTS (1 << 18)
+int hugePageScan(driver_params *ep, size_t bytes, int ***arrays)
+{
+    int len = HUGE_SCAN_INTS;
+    int num_arrays = (int) (bytes / (len * sizeof(int)));
+    long i, reads = (long) num_arrays * len;
+    unsigned long x = (unsigned long) ep->Seed | 1;
+    int j;
+    int **a;
+    long sum = 0, check = 0;
+    clock_t start, end;
+
+    a = (int **) malloc(num_arrays * sizeof(int *));
+    assert(a != NULL);
+    for (j = 0; j < num_arrays; j++) {
+        a[j] = (int *) Mem_alloc(len * sizeof(int));
+        assert(a[j] != NULL);
+    }
+
+    start = clock();
+    for (j = 0; j < num_arrays; j++)
+        for (i = 0; i < len; i++)
+            a[j][i] = (int) (j + i);
+    end = clock();
+    printf("  fill:        %g ms\n", 1000*((double)(end-start))/CLOCKS_PER_SEC);
+
+    start = clock();
+    for (j = 0; j < num_arrays; j++)
+        for (i = 0; i < len; i++)
+            sum += a[j][i];
+    end = clock();
+    printf("  scan:        %g ms\n", 1000*((double)(end-start))/CLOCKS_PER_SEC);
+
+    start = clock();
+    for (i = 0; i < reads; i++) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        j = (int) ((x >> 20) % num_arrays);
+        check += a[j][x % len] - j;
+    }
+    end = clock();
+    printf("  random scan: %g ms (%ld reads)\n",
+            1000*((double)(end-start))/CLOCKS_PER_SEC, reads);
+
+    // use the sums so the loops are not optimized away
+    if (ep->Verbose) printf("  sums %ld %ld\n", sum, check);
+    *arrays = a;
+    return num_arrays;
+}
+
+/* ----- hugePageDriver -----
+ *
+ * runs hugePageScan with sbrk pages and then with huge page reservations
+ */
+void hugePageDriver(driver_params *ep)
+{
+    size_t bytes = (size_t) ep->HugeScanMiB << 20;
+    int **small_arrays, **huge_arrays;
+    int num_small, num_huge, j;
+    int saved = HugePages;
+
+    printf("\nHuge page test driver\n");
+    printf("  %zu bytes in arrays of %d integers in each pass\n",
+            bytes, HUGE_SCAN_INTS);
+
+    printf("4 KiB pages from sbrk\n");
+    HugePages = FALSE;
+    num_small = hugePageScan(ep, bytes, &small_arrays);
+
+    printf("Huge page reservations\n");
+    HugePages = TRUE;
+    num_huge = hugePageScan(ep, bytes, &huge_arrays);
+
+    for (j = 0; j < num_small; j++)
+        Mem_free(small_arrays[j]);
+    for (j = 0; j < num_huge; j++)
+        Mem_free(huge_arrays[j]);
+    free(small_arrays);
+    free(huge_arrays);
+    HugePages = saved;
+    Mem_stats();
+    printf("----- End of huge page test -----\n\n");
+}
+
+/* ----- listDriver -----
+ *
+ * list elements point into one array of integers, so only the list itself
+ * is allocated per element.  The lists are built by appending, which for
+ * list.c leaves the nodes in malloc order, the best case for its walks.
+ * The search looks for the last element, so it visits every element
+ * without the validation list_elem_find does when nothing matches.
+ */
+static int listDriverCompare(const data_t *a, const data_t *b)
+{
+    return *(const int *) a != *(const int *) b;
+}
+
+void listDriver(driver_params *ep)
+{
+    long max_n = 1, n, r, reps;
+    long sum;
+    int i, p;
+    int *vals;
+    ListPtr L;
+    IteratorPtr idx;
+    clock_t start, end;
+    double walk_ms, find_ms;
+
+    for (p = 0; p < ep->ListMaxPow; p++)
+        max_n *= 10;
+#ifdef LIST_UNROLLED
+    printf("\nList driver with unrolled list, %d elements per chunk\n",
+            (int) LIST_CHUNK_SLOTS);
+#else
+    printf("\nList driver with one node per element\n");
+#endif
+    printf("%10s %10s %14s %14s\n", "elements", "reps", "walk ns/elem", "find ns/elem");
+    for (n = 1000; n <= max_n; n *= 10) {
+        vals = (int *) malloc(n * sizeof(int));
+        assert(vals != NULL);
+        L = list_construct(NULL);
+        for (i = 0; i < n; i++) {
+            vals[i] = i;
+            list_insert_at(L, (data_t *) &vals[i], list_size(L));
+        }
+        reps = max_n / n;
+
+        sum = 0;
+        start = clock();
+        for (r = 0; r < reps; r++)
+            for (idx = list_iter_at(L, 0); idx != NULL; idx = list_iter_next(idx))
+                sum += *(int *) list_access(L, idx);
+        end = clock();
+        walk_ms = 1000*((double)(end-start))/CLOCKS_PER_SEC;
+        assert(sum == reps * (n * (n - 1) / 2));
+
+        start = clock();
+        for (r = 0; r < reps; r++) {
+            idx = list_elem_find(L, (data_t *) &vals[n-1], listDriverCompare);
+            assert(idx != NULL && list_access(L, idx) == (data_t *) &vals[n-1]);
+        }
+        end = clock();
+        find_ms = 1000*((double)(end-start))/CLOCKS_PER_SEC;
+
+        printf("%10ld %10ld %14.2f %14.2f\n", n, reps,
+                1e6*walk_ms/(reps*n), 1e6*find_ms/(reps*n));
+
+        // remove the elements so list_destruct does not free the array
+        while (list_size(L) > 0)
+            list_remove(L, NULL);
+        list_destruct(L);
+        free(vals);
+    }
+    printf("----- End of list test -----\n\n");
+}
+
+/* ----- intrusiveDriver -----
+ *
+ * each array is a qblock_t.  The link is only used by the ilist queue; the
+ * ADT queue stores a pointer to the block like the equilibrium driver.
+ */
+typedef struct {
+    ilist_link_t link;
+    int size;
+    int ints[];
+} qblock_t;
+
+static void qblockCheck(qblock_t *b)
+{
+    assert(b != NULL && b->size > 0);
+    assert(b->ints[b->size-1] == -b->ints[0]);
+}
+
+void intrusiveDriver(driver_params *ep)
+{
+    int n = ep->WarmUp;
+    int i, t, size;
+    qblock_t **blocks;
+    qblock_t *b;
+    ListPtr L;
+    ilist_t Q;
+    clock_t start, end;
+    double adt_ms, intrusive_ms;
+    double ops = 2.0 * n + 2.0 * ep->Trials;
+
+    printf("\nIntrusive list test driver\n");
+    printf("  %d arrays in the queue, %d cycles\n", n, ep->Trials);
+
+    blocks = (qblock_t **) malloc(n * sizeof(qblock_t *));
+    assert(blocks != NULL);
+    for (i = 0; i < n; i++) {
+        size = ep->AvgNumInts;
+        b = (qblock_t *) Mem_alloc(sizeof(qblock_t) + size * sizeof(int));
+        assert(b != NULL);
+        b->size = size;
+        b->ints[0] = i;
+        b->ints[size-1] = -i;
+        blocks[i] = b;
+    }
+
+    start = clock();
+    L = list_construct(NULL);
+    for (i = 0; i < n; i++)
+        list_insert_at(L, (data_t *) blocks[i], list_size(L));
+    for (t = 0; t < ep->Trials; t++) {
+        b = (qblock_t *) list_remove(L, NULL);
+        qblockCheck(b);
+        list_insert_at(L, (data_t *) b, list_size(L));
+    }
+    for (i = 0; i < n; i++) {
+        b = (qblock_t *) list_remove(L, NULL);
+        qblockCheck(b);
+    }
+    end = clock();
+    adt_ms = 1000*((double)(end-start))/CLOCKS_PER_SEC;
+    list_destruct(L);
+
+    start = clock();
+    ilist_init(&Q);
+    for (i = 0; i < n; i++)
+        ilist_insert(&Q, &blocks[i]->link, NULL);
+    for (t = 0; t < ep->Trials; t++) {
+        b = ilist_entry(ilist_remove(&Q, NULL), qblock_t, link);
+        qblockCheck(b);
+        ilist_insert(&Q, &b->link, NULL);
+    }
+    for (i = 0; i < n; i++) {
+        b = ilist_entry(ilist_remove(&Q, NULL), qblock_t, link);
+        // the queue keeps its order, so after the cycles the blocks come
+        // out rotated by Trials
+        assert(b == blocks[(i + ep->Trials) % n]);
+        qblockCheck(b);
+    }
+    end = clock();
+    intrusive_ms = 1000*((double)(end-start))/CLOCKS_PER_SEC;
+    assert(ilist_size(&Q) == 0);
+
+    printf("List ADT: time=%g, %g ns per operation\n", adt_ms, 1e6*adt_ms/ops);
+    printf("ilist:    time=%g, %g ns per operation\n", intrusive_ms,
+            1e6*intrusive_ms/ops);
+
+    for (i = 0; i < n; i++)
+        Mem_free(blocks[i]);
+    free(blocks);
+    printf("----- End of intrusive list test -----\n\n");
+}
+
+/* ----- sortDriver -----
+ *
+ * the keys are random integers with many repeats, and every list element
+ * points into one array of keys, so the check after a sort can tell from
+ * the addresses that equal keys kept their order.  Sorts are timed with
+ * the wall clock, since clock() adds up the time of all threads.
+ */
+static double sortDriverWallMs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return 1000.0*ts.tv_sec + ts.tv_nsec/1e6;
+}
+
+static int sortDriverCompare(const data_t *a, const data_t *b)
+{
+    int x = *(const int *) a, y = *(const int *) b;
+    if (x < y) return 1;
+    if (x > y) return -1;
+    return 0;
+}
+
+/* builds a list of the n keys in array order, or in sorted order with
+ * list_insert_sorted if sorted is TRUE, and returns the time it took
+ */
+static double sortDriverBuild(ListPtr L, int *keys, long n, int sorted)
+{
+    clock_t start, end;
+    long i;
+
+    start = clock();
+    for (i = 0; i < n; i++) {
+        if (sorted)
+            list_insert_sorted(L, (data_t *) &keys[i]);
+        else
+            list_insert_at(L, (data_t *) &keys[i], list_size(L));
+    }
+    end = clock();
+    return 1000*((double)(end-start))/CLOCKS_PER_SEC;
+}
+
+/* checks that L holds the n keys in order, stable, and empties it */
+static void sortDriverCheck(ListPtr L, long n)
+{
+    int *prev = NULL, *cur;
+    IteratorPtr idx;
+    long count = 0;
+
+    for (idx = list_iter_at(L, 0); idx != NULL; idx = list_iter_next(idx)) {
+        cur = (int *) list_access(L, idx);
+        if (prev != NULL)
+            assert(*prev < *cur || (*prev == *cur && prev < cur));
+        prev = cur;
+        count++;
+    }
+    assert(count == n);
+    while (list_size(L) > 0)
+        list_remove(L, NULL);
+}
+
+void sortDriver(driver_params *ep)
+{
+    long max_n = 1, n, i;
+    int p, type;
+    int *keys;
+    ListPtr L;
+    double start, ms[2], insert_ms;
+
+    for (p = 0; p < ep->SortMaxPow; p++)
+        max_n *= 10;
+    printf("\nSort driver with %d threads for the parallel sort\n", LIST_SORT_THREADS);
+    printf("%10s %14s %14s %20s\n", "elements", "merge ms", "parallel ms",
+            "insert_sorted ms");
+    for (n = 10000; n <= max_n; n *= 10) {
+        keys = (int *) malloc(n * sizeof(int));
+        assert(keys != NULL);
+        for (i = 0; i < n; i++)
+            keys[i] = (int) (drand48() * (n / 4));
+        for (type = SORT_MERGE; type <= SORT_MERGE_PARALLEL; type++) {
+            L = list_construct(NULL);
+            sortDriverBuild(L, keys, n, FALSE);
+            start = sortDriverWallMs();
+            sort(L, type, sortDriverCompare);
+            ms[type - SORT_MERGE] = sortDriverWallMs() - start;
+            sortDriverCheck(L, n);
+            list_destruct(L);
+        }
+        if (n <= 10000) {
+            L = list_construct(sortDriverCompare);
+            insert_ms = sortDriverBuild(L, keys, n, TRUE);
+            sortDriverCheck(L, n);
+            list_destruct(L);
+            printf("%10ld %14.1f %14.1f %20.1f\n", n, ms[0], ms[1], insert_ms);
+        } else {
+            printf("%10ld %14.1f %14.1f %20s\n", n, ms[0], ms[1], "-");
+        }
+        free(keys);
+    }
+    printf("----- End of sort test -----\n\n");
+}
+
+/* ----- concurrentDriver -----
+ *
+ * Mem_alloc is not thread safe, so the items are slots of one array from
+ * malloc and the threads never allocate through mem.c.  Item k of
+ * producer p is items[p*per + k] and holds k, so a consumer can tell
+ * from the address which producer an item came from.  Consumers and
+ * producers that find the queue empty or full call sched_yield, which
+ * lets the other side run when there are more threads than CPUs.
+ */
+typedef struct {
+    int mode;                   // 0 for the mutex list, 1 for the queue
+    int producers;
+    long per;                   // items per producer
+    int *items;
+    atomic_char *seen;          // times each item was consumed
+    atomic_long consumed;
+    pthread_mutex_t lock;       // guards list for mode 0
+    ListPtr list;
+    clist_queue_t *queue;
+    clist_t *clist;             // for the stress test
+    long ops;                   // operations per stress thread
+} concurrent_shared_t;
+
+typedef struct {
+    concurrent_shared_t *sh;
+    int id;
+    long next;                  // items a stress thread inserted
+} concurrent_arg_t;
+
+static double concurrentWallMs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return 1000.0*ts.tv_sec + ts.tv_nsec/1e6;
+}
+
+static void *concurrentProducer(void *arg)
+{
+    concurrent_arg_t *a = (concurrent_arg_t *) arg;
+    concurrent_shared_t *sh = a->sh;
+    int *item = sh->items + a->id * sh->per;
+    long k;
+
+    for (k = 0; k < sh->per; k++) {
+        if (sh->mode == 0) {
+            pthread_mutex_lock(&sh->lock);
+            list_insert_at(sh->list, (data_t *) &item[k], list_size(sh->list));
+            pthread_mutex_unlock(&sh->lock);
+        } else {
+            while (!clist_queue_push(sh->queue, (data_t *) &item[k]))
+                sched_yield();
+        }
+    }
+    return NULL;
+}
+
+static void *concurrentConsumer(void *arg)
+{
+    concurrent_arg_t *a = (concurrent_arg_t *) arg;
+    concurrent_shared_t *sh = a->sh;
+    long total = sh->per * sh->producers;
+    long *last, offset;
+    int *item;
+    int p;
+
+    last = (long *) malloc(sh->producers * sizeof(long));
+    assert(last != NULL);
+    for (p = 0; p < sh->producers; p++)
+        last[p] = -1;
+    while (atomic_load(&sh->consumed) < total) {
+        if (sh->mode == 0) {
+            pthread_mutex_lock(&sh->lock);
+            item = (int *) list_remove(sh->list, NULL);
+            pthread_mutex_unlock(&sh->lock);
+        } else {
+            item = (int *) clist_queue_pop(sh->queue);
+        }
+        if (item == NULL) {
+            sched_yield();
+            continue;
+        }
+        offset = item - sh->items;
+        assert(0 <= offset && offset < total);
+        p = offset / sh->per;
+        assert(*item == offset % sh->per);
+        // first in first out: a producer's items come out in the order it
+        // put them in, whichever consumer gets them
+        assert(*item > last[p]);
+        last[p] = *item;
+        atomic_fetch_add(&sh->seen[offset], 1);
+        atomic_fetch_add(&sh->consumed, 1);
+    }
+    free(last);
+    return NULL;
+}
+
+/* one run with n producers and n consumers; returns the wall time */
+static double concurrentPipeline(concurrent_shared_t *sh, int n)
+{
+    pthread_t *threads;
+    concurrent_arg_t *args;
+    long total = sh->per * n, k;
+    double start, ms;
+    int t;
+
+    threads = (pthread_t *) malloc(2 * n * sizeof(pthread_t));
+    args = (concurrent_arg_t *) malloc(2 * n * sizeof(concurrent_arg_t));
+    assert(threads != NULL && args != NULL);
+    sh->producers = n;
+    for (k = 0; k < total; k++)
+        atomic_init(&sh->seen[k], 0);
+    atomic_init(&sh->consumed, 0);
+
+    start = concurrentWallMs();
+    for (t = 0; t < 2 * n; t++) {
+        args[t].sh = sh;
+        args[t].id = t < n ? t : t - n;
+        pthread_create(&threads[t], NULL,
+                t < n ? concurrentProducer : concurrentConsumer, &args[t]);
+    }
+    for (t = 0; t < 2 * n; t++)
+        pthread_join(threads[t], NULL);
+    ms = concurrentWallMs() - start;
+
+    for (k = 0; k < total; k++)
+        assert(atomic_load(&sh->seen[k]) == 1);
+    free(threads);
+    free(args);
+    return ms;
+}
+
+/* each stress thread inserts and removes at random positions.  Inserted
+ * items are the thread's own slots of items, so every item is in the
+ * list at most once; removed items are counted in seen.
+ */
+static void *concurrentStress(void *arg)
+{
+    concurrent_arg_t *a = (concurrent_arg_t *) arg;
+    concurrent_shared_t *sh = a->sh;
+    int *item = sh->items + a->id * sh->per;
+    unsigned int x = 2463534242u + 7919 * a->id;
+    long next = 0, k;
+    int size, *removed;
+
+    for (k = 0; k < sh->ops; k++) {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        if (sh->mode == 0)
+            pthread_mutex_lock(&sh->lock);
+        size = sh->mode == 0 ? list_size(sh->list) : clist_size(sh->clist);
+        if ((x & 1) && next < sh->per) {
+            if (sh->mode == 0)
+                list_insert_at(sh->list, (data_t *) &item[next], (x >> 1) % (size + 1));
+            else
+                clist_insert_at(sh->clist, (data_t *) &item[next], (x >> 1) % (size + 1));
+            next++;
+        } else if (size > 0) {
+            if (sh->mode == 0)
+                removed = (int *) list_remove_at(sh->list, (x >> 1) % size);
+            else
+                removed = (int *) clist_remove_at(sh->clist, (x >> 1) % size);
+            // another thread can shorten a clist_t after size was read
+            if (removed != NULL)
+                atomic_fetch_add(&sh->seen[removed - sh->items], 1);
+        }
+        if (sh->mode == 0)
+            pthread_mutex_unlock(&sh->lock);
+    }
+    a->next = next;
+    return NULL;
+}
+
+/* stress run with n threads and w items to start; returns the wall time */
+static double concurrentStressRun(concurrent_shared_t *sh, int n, int w)
+{
+    pthread_t *threads;
+    concurrent_arg_t *args;
+    long total = sh->per * n + w, k;
+    double start, ms;
+    int *item;
+    int t;
+
+    threads = (pthread_t *) malloc(n * sizeof(pthread_t));
+    args = (concurrent_arg_t *) malloc(n * sizeof(concurrent_arg_t));
+    assert(threads != NULL && args != NULL);
+    for (k = 0; k < total; k++)
+        atomic_init(&sh->seen[k], 0);
+    // the starting items are the slots after those of the n threads
+    for (k = 0; k < w; k++) {
+        item = &sh->items[n * sh->per + k];
+        if (sh->mode == 0)
+            list_insert_at(sh->list, (data_t *) item, k);
+        else
+            clist_insert_at(sh->clist, (data_t *) item, k);
+    }
+
+    start = concurrentWallMs();
+    for (t = 0; t < n; t++) {
+        args[t].sh = sh;
+        args[t].id = t;
+        pthread_create(&threads[t], NULL, concurrentStress, &args[t]);
+    }
+    for (t = 0; t < n; t++)
+        pthread_join(threads[t], NULL);
+    ms = concurrentWallMs() - start;
+
+    // empty the list; then every item that went in came out exactly once
+    if (sh->mode == 0) {
+        while (list_size(sh->list) > 0)
+            atomic_fetch_add(&sh->seen[(int *) list_remove(sh->list, NULL) - sh->items], 1);
+    } else {
+        while ((item = (int *) clist_remove_at(sh->clist, 0)) != NULL)
+            atomic_fetch_add(&sh->seen[item - sh->items], 1);
+        assert(clist_size(sh->clist) == 0);
+    }
+    // the slots a thread inserted came out once, and the rest never
+    for (t = 0; t < n; t++)
+        for (k = 0; k < sh->per; k++)
+            assert(atomic_load(&sh->seen[t * sh->per + k]) == (k < args[t].next));
+    for (k = 0; k < w; k++)
+        assert(atomic_load(&sh->seen[n * sh->per + k]) == 1);
+    free(threads);
+    free(args);
+    return ms;
+}
+
+void concurrentDriver(driver_params *ep)
+{
+    concurrent_shared_t sh;
+    int max = ep->ConcurrentThreads;
+    int n, w = ep->WarmUp;
+    long k, slots;
+    double ms[2];
+
+    printf("\nConcurrent list test driver\n");
+    printf("  %d items per run, up to %d producers and %d consumers\n",
+            ep->Trials, max, max);
+    // enough slots for the pipeline or for the stress test, where each of
+    // max threads gets Trials/max rounded up and w more are in the list
+    slots = (long) ep->Trials + max + w;
+    sh.items = (int *) malloc(slots * sizeof(int));
+    sh.seen = (atomic_char *) malloc(slots * sizeof(atomic_char));
+    assert(sh.items != NULL && sh.seen != NULL);
+    pthread_mutex_init(&sh.lock, NULL);
+
+    printf("%10s %18s %18s\n", "producers", "mutex list Mops/s", "queue Mops/s");
+    // 1, 2, 4, ... and always max last
+    for (n = 1; n <= max; n = (n < max && 2 * n > max) ? max : 2 * n) {
+        sh.per = ep->Trials / n;
+        for (k = 0; k < sh.per * n; k++)
+            sh.items[k] = k % sh.per;
+        for (sh.mode = 0; sh.mode <= 1; sh.mode++) {
+            sh.list = list_construct(NULL);
+            sh.queue = clist_queue_construct(1024);
+            ms[sh.mode] = concurrentPipeline(&sh, n);
+            assert(list_size(sh.list) == 0 && clist_queue_size(sh.queue) == 0);
+            list_destruct(sh.list);
+            clist_queue_destruct(sh.queue);
+        }
+        printf("%10d %18.2f %18.2f\n", n, sh.per * n / ms[0] / 1000,
+                sh.per * n / ms[1] / 1000);
+    }
+
+    printf("Stress test: %d threads, %d ops, random positions, %d items to start\n",
+            max, ep->Trials, w);
+    sh.per = (ep->Trials + max - 1) / max;
+    sh.ops = sh.per;
+    for (k = 0; k < slots; k++)
+        sh.items[k] = k;
+    for (sh.mode = 0; sh.mode <= 1; sh.mode++) {
+        if (sh.mode == 0)
+            sh.list = list_construct(NULL);
+        else
+            sh.clist = clist_construct();
+        ms[sh.mode] = concurrentStressRun(&sh, max, w);
+        if (sh.mode == 0)
+            list_destruct(sh.list);
+        else
+            clist_destruct(sh.clist);
+    }
+    printf("list_t with mutex: time=%g ms\n", ms[0]);
+    printf("clist_t:           time=%g ms\n", ms[1]);
+
+    pthread_mutex_destroy(&sh.lock);
+    free(sh.items);
+    free(sh.seen);
+    printf("----- End of concurrent list test -----\n\n");
+}
 
 /* read in command line arguments.  Note that Coalescing and SearchPolicy 
  * are stored in global variables for easy access by other 
@@ -493,8 +1635,17 @@ void getCommandLine(int argc, char **argv, driver_params *ep)
     ep->RangeInts = 127;
     ep->SysMalloc = FALSE;
     ep->UnitDriver = -1;
+    ep->CompactTest = FALSE;
+    ep->LifetimeTest = FALSE;
+    ep->BatchTest = FALSE;
+    ep->LargeHeapGiB = 0;
+    ep->HugeScanMiB = 0;
+    ep->ListMaxPow = 0;
+    ep->IntrusiveTest = FALSE;
+    ep->SortMaxPow = 0;
+    ep->ConcurrentThreads = 0;
 
-    while ((c = getopt(argc, argv, "w:t:s:a:r:f:u:cdve")) != -1) {
+    while ((c = getopt(argc, argv, "w:t:s:a:r:f:u:l:g:S:L:O:C:cdvekbHi")) != -1) {
         switch(c) {
             case 'u': ep->UnitDriver = atoi(optarg);   break;
             case 'w': ep->WarmUp = atoi(optarg);       break;
@@ -505,7 +1656,28 @@ void getCommandLine(int argc, char **argv, driver_params *ep)
             case 'd': ep->SysMalloc = TRUE;            break;
             case 'v': ep->Verbose = TRUE;              break;
             case 'e': ep->EquilibriumTest = TRUE;      break;
+            case 'k': ep->CompactTest = TRUE;          break;
+            case 'b': ep->BatchTest = TRUE;            break;
+            case 'g': ep->LargeHeapGiB = atoi(optarg); break;
+            case 'S': ep->HugeScanMiB = atoi(optarg);  break;
+            case 'L': ep->ListMaxPow = atoi(optarg);   break;
+            case 'i': ep->IntrusiveTest = TRUE;        break;
+            case 'O': ep->SortMaxPow = atoi(optarg);   break;
+            case 'C': ep->ConcurrentThreads = atoi(optarg); break;
             case 'c': Coalescing = TRUE;               break;
+            case 'H': HugePages = TRUE;                break;
+            case 'l':
+                  if (strcmp(optarg, "plain") == 0)
+                      ep->LifetimeTest = 1;
+                  else if (strcmp(optarg, "tagged") == 0)
+                      ep->LifetimeTest = 2;
+                  else if (strcmp(optarg, "site") == 0)
+                      ep->LifetimeTest = 3;
+                  else {
+                      fprintf(stderr, "invalid lifetime driver mode: %s\n", optarg);
+                      exit(1);
+                  }
+                  break;
             case 'f':
                   if (strcmp(optarg, "best") == 0)
                       SearchPolicy = BEST_FIT;
@@ -527,10 +1699,21 @@ void getCommandLine(int argc, char **argv, driver_params *ep)
                   printf("  -v        turn on verbose prints (default off)\n");
                   printf("  -s 54321  seed for random number generator\n");
                   printf("  -c        turn on coalescing (default off)\n");
+                  printf("  -H        heap pages from huge page reservations (default off)\n");
                   printf("  -f best|first\n");
                   printf("            search policy to find memory block (first by default)\n");
                   printf("  -u 0      run unit test driver\n");
                   printf("  -e        run equilibrium test driver\n");
+                  printf("  -k        run compaction test driver\n");
+                  printf("  -b        run batch allocation driver\n");
+                  printf("  -g 3      run large heap driver with 3 GiB total\n");
+                  printf("  -S 256    run huge page driver with 256 MiB per pass\n");
+                  printf("  -L 7      run list driver up to 10^7 elements\n");
+                  printf("  -i        run intrusive list driver\n");
+                  printf("  -O 7      run sort driver up to 10^7 elements\n");
+                  printf("  -C 4      run concurrent list driver with up to 4 producers\n");
+                  printf("  -l plain|tagged|site\n");
+                  printf("            run lifetime driver with Mem_alloc, Mem_alloc_tagged, or MEM_ALLOC_SITE\n");
                   printf("\nOptions for equilibrium test driver ---------\n");
                   printf("  -w 1000   number of warmup allocations\n");
                   printf("  -t 100000 number of trials in equilibrium\n");
@@ -6,6 +6,7 @@
 
 #include <stdlib.h>
 #include <assert.h>
+#include <pthread.h>
 
 #include "datatypes.h"   /* defines data_t */
 #include "list.h"        /* defines public functions for list ADT */
@@ -16,8 +17,27 @@
 #define SORTED_LIST   -123465
 #define UNSORTED_LIST -632154
 
+/* nodes for list_from_array are carved from one block.  Blocks stay with
+ * the list that holds their nodes and are freed by list_destruct; a
+ * removed node from a block goes on the free_nodes chain of its list and
+ * is used again by the next insert.  The blocks of a list form a circular
+ * chain and list_t.blocks points to the last one, so two chains can be
+ * joined in O(1).
+ */
+typedef struct list_block_tag {
+    struct list_block_tag *next;
+} list_block_t;
+
+/* the index part of a node of an indexed list */
+#define IX(n) ((list_inode_t *) (n))
+
 /* prototypes for private functions used in list.c only */
 void list_debug_validate(list_t *L);
+static void list_check(list_t *L);
+static void list_index_link(list_t *L, list_inode_t *n);
+static void list_index_unlink(list_t *L, list_inode_t *n);
+static list_node_t *list_node_alloc(list_t *L);
+static void list_node_release(list_t *L, list_node_t *n);
 
 /* ----- below are the functions  ----- */
 
@@ -41,6 +61,10 @@ list_t * list_construct(int (*compare_function)(const data_t *, const data_t *))
     L->head = NULL;
     L->tail = NULL;
     L->current_list_size = 0;
+    L->indexed = 0;
+    L->root = NULL;
+    L->free_nodes = NULL;
+    L->blocks = NULL;
     L->comp_proc = compare_function;
     if (compare_function == NULL)
         L->list_sorted_state = UNSORTED_LIST;
@@ -48,7 +72,63 @@ list_t * list_construct(int (*compare_function)(const data_t *, const data_t *))
         L->list_sorted_state = SORTED_LIST;
 
     /* the last line of this function must call validate */
-    list_debug_validate(L);
+    list_check(L);
+    return L;
+}
+
+/* Allocates a new, empty list that also keeps its nodes in a tree ordered
+ * by position, so that list_iter_at, list_insert_at, and list_remove_at
+ * take O(log n) time instead of walking the list.  All other functions
+ * work as for a list from list_construct and keep the tree up to date.
+ *
+ * The tree is a treap: each node gets a random priority and the tree is
+ * kept in heap order by priority, which keeps its expected depth O(log n).
+ * Each node also counts the nodes in its subtree, which is how a position
+ * is found.
+ *
+ * While the list is sorted, position order is also comp_proc order, so
+ * the same tree is a search tree.  list_insert_sorted and list_elem_find
+ * with comp_proc then descend it in O(log n) expected time instead of
+ * walking the list.
+ */
+list_t * list_construct_indexed(int (*compare_function)(const data_t *, const data_t *))
+{
+    list_t *L = list_construct(compare_function);
+    L->indexed = 1;
+    return L;
+}
+
+/* Allocates a new, unsorted list that holds the n pointers in elems, in
+ * order.  All n nodes come from one allocation, which is kept until
+ * list_destruct; nodes removed in the meantime are reused by later
+ * inserts into the same list.
+ */
+list_t * list_from_array(data_t **elems, int n)
+{
+    list_t *L = list_construct(NULL);
+    list_block_t *block;
+    list_node_t *nodes;
+    int i;
+
+    assert(n >= 0 && (n == 0 || elems != NULL));
+    if (n == 0)
+        return L;
+    block = (list_block_t *) malloc(sizeof(list_block_t) + n*sizeof(list_node_t));
+    assert(block != NULL);
+    block->next = block;
+    L->blocks = block;
+    nodes = (list_node_t *) (block + 1);
+    for (i = 0; i < n; i++) {
+        assert(elems[i] != NULL);
+        nodes[i].data_ptr = elems[i];
+        nodes[i].prev = i > 0 ? &nodes[i-1] : NULL;
+        nodes[i].next = i < n-1 ? &nodes[i+1] : NULL;
+        nodes[i].pooled = 1;
+    }
+    L->head = &nodes[0];
+    L->tail = &nodes[n-1];
+    L->current_list_size = n;
+    list_check(L);
     return L;
 }
 
@@ -62,16 +142,26 @@ void list_destruct(list_t *list_ptr)
     assert(list_ptr != NULL);
 
     /* the first line must validate the list */
-    list_debug_validate(list_ptr);
+    list_check(list_ptr);
     list_node_t *index;
     index = list_ptr->tail;
     while(list_ptr->tail != NULL){ //while loop which frees every node and it's data_ptr
         list_ptr->tail = list_ptr->tail->prev;
         free(index->data_ptr); //free statement
         index->data_ptr = NULL;
-        free(index); //free statement
+        if(!index->pooled){
+            free(index); //free statement
+        }
         index = list_ptr->tail;
     }
+    if(list_ptr->blocks != NULL){ //pooled nodes go with their blocks
+        list_block_t *block = list_ptr->blocks->next, *next;
+        list_ptr->blocks->next = NULL;
+        for(; block != NULL; block = next){
+            next = block->next;
+            free(block);
+        }
+    }
     free(list_ptr); //frees the actual header block
 
 }
@@ -82,7 +172,7 @@ void list_destruct(list_t *list_ptr)
 list_node_t * list_iter_front(list_t *list_ptr)
 {
     assert(list_ptr != NULL);
-    list_debug_validate(list_ptr);
+    list_check(list_ptr);
     return list_ptr->head;
 
 }
@@ -93,7 +183,7 @@ list_node_t * list_iter_front(list_t *list_ptr)
 list_node_t * list_iter_back(list_t *list_ptr)
 {
     assert(list_ptr != NULL);
-    list_debug_validate(list_ptr);
+    list_check(list_ptr);
     return list_ptr->tail;
 }
 
@@ -110,6 +200,47 @@ list_node_t * list_iter_next(list_node_t * idx_ptr)
     return idx_ptr->next;
 }
 
+/* Return an Iterator that points to the element at position pos, where the
+ * first element is at position 0.  If pos is not between 0 and
+ * list_size - 1 the value that is returned is NULL.
+ *
+ * For a list from list_construct_indexed this takes O(log n) time.  Other
+ * lists are walked from whichever end is closer.
+ */
+list_node_t * list_iter_at(list_t *list_ptr, int pos)
+{
+    list_node_t *n;
+    list_inode_t *x;
+    int left;
+
+    assert(list_ptr != NULL);
+    if (pos < 0 || pos >= list_ptr->current_list_size)
+        return NULL;
+    if (list_ptr->indexed) {
+        x = list_ptr->root;
+        while (x != NULL) {
+            left = x->left == NULL ? 0 : x->left->weight;
+            if (pos < left)
+                x = x->left;
+            else if (pos == left)
+                return &x->node;
+            else {
+                pos -= left + 1;
+                x = x->right;
+            }
+        }
+        assert(0);   // the subtree counts do not match the list size
+    }
+    if (pos < list_ptr->current_list_size/2) {
+        for (n = list_ptr->head; pos > 0; pos--)
+            n = n->next;
+    } else {
+        for (n = list_ptr->tail; pos < list_ptr->current_list_size - 1; pos++)
+            n = n->prev;
+    }
+    return n;
+}
+
 /* Obtains a pointer to an element stored in the specified list, at the
  * specified Iterator position
  * 
@@ -130,17 +261,7 @@ data_t * list_access(list_t *list_ptr, list_node_t * idx_ptr)
     assert(list_ptr != NULL);
     if (idx_ptr == NULL || list_ptr->head == NULL)
 	return NULL;
-
-    list_node_t *temp = list_ptr->head;
-    while(temp != NULL){ //iterates through the list
-        if(temp->next == idx_ptr->next){ //&& temp->next != NULL){
-            return temp->data_ptr; //returns the data_ptr if the iteration matches with given parameter;
-        }
-        temp = temp->next; //goes through temp
-    }
-    /* debugging function to verify that the structure of the list is valid */
-    list_debug_validate(list_ptr);
-    return NULL;
+    return idx_ptr->data_ptr; //the iterator is the node itself
 }
 
 /* Finds an element in a list and returns a pointer to it.
@@ -162,6 +283,24 @@ data_t * list_access(list_t *list_ptr, list_node_t * idx_ptr)
 list_node_t * list_elem_find(list_t *list_ptr, data_t *elem_ptr,
         int (*compare_function)(const data_t *, const data_t *))
 {
+    if (list_ptr->indexed && list_ptr->list_sorted_state == SORTED_LIST
+            && compare_function == list_ptr->comp_proc) {
+        // descend to the first element that is not before elem_ptr; if
+        // any element matches, that one is the first match
+        list_inode_t *at = list_ptr->root, *first = NULL;
+        while (at != NULL) {
+            if (compare_function(at->node.data_ptr, elem_ptr) == 1)
+                at = at->right;
+            else {
+                first = at;
+                at = at->left;
+            }
+        }
+        if (first != NULL && compare_function(elem_ptr, first->node.data_ptr) == 0)
+            return &first->node;
+        list_check(list_ptr);
+        return NULL;
+    }
 
     list_node_t *temp = list_ptr->head;
     while(temp != NULL){ //iterates through temp
@@ -172,7 +311,7 @@ list_node_t * list_elem_find(list_t *list_ptr, data_t *elem_ptr,
         temp = temp->next; //temp become the value after it
     }
 
-    list_debug_validate(list_ptr);
+    list_check(list_ptr);
     /* fix the return value */
     return NULL;
 }
@@ -216,11 +355,11 @@ void list_insert(list_t *list_ptr, data_t *elem_ptr, list_node_t * idx_ptr)
 
     /* insert your code here */
     list_ptr->list_sorted_state = UNSORTED_LIST; //makes list unsorted if function is used
-    list_node_t *new = (list_node_t*) malloc(sizeof(list_node_t));
+    list_node_t *new = list_node_alloc(list_ptr);
     new->next = NULL;
     new->prev = NULL;
     if(idx_ptr == NULL){
-        list_node_t *last = list_ptr->head; //sets last equal to the first element in the list
+        list_node_t *last = list_ptr->tail; //the tail is known, so there is no walk
 
         new->data_ptr = elem_ptr; //fills data in new
         new->next = NULL;
@@ -231,9 +370,6 @@ void list_insert(list_t *list_ptr, data_t *elem_ptr, list_node_t * idx_ptr)
             list_ptr->tail = new;
         }
         else{
-            while(last->next != NULL){
-               last = last->next; //goes through the list
-            }
             last->next = new;
             new->prev = last;
             list_ptr->tail = new; //new becomes the tail of the list
@@ -280,13 +416,15 @@ void list_insert(list_t *list_ptr, data_t *elem_ptr, list_node_t * idx_ptr)
     }
     list_ptr->tail->next = NULL; //makes sure that only the list values are not equal to NULL
     list_ptr->head->prev = NULL;
+    if (list_ptr->indexed)
+        list_index_link(list_ptr, IX(new));
 
     /* insert your code here */
 
     /* the last two lines of this function must be the following */
     if (list_ptr->list_sorted_state == SORTED_LIST) 
 	list_ptr->list_sorted_state = UNSORTED_LIST;
-    list_debug_validate(list_ptr);
+    list_check(list_ptr);
 }
 
 /* Inserts the element into the specified sorted list at the proper position,
@@ -322,14 +460,35 @@ void list_insert_sorted(list_t *list_ptr, data_t *elem_ptr)
     assert(list_ptr->list_sorted_state == SORTED_LIST);
 
     /* insert your code here */
-    list_node_t *new = (list_node_t*) malloc(sizeof(list_node_t));
+    list_node_t *new = list_node_alloc(list_ptr);
     new->prev = NULL; //makes sure that the new node is completely NULL
     new->next = NULL;
     new->data_ptr = elem_ptr; //fills new with data
     list_node_t *temp;
     temp = list_ptr->tail;
 
-    if(list_ptr->current_list_size == 0){ //case if the list if empty
+    if(list_ptr->indexed && list_ptr->current_list_size > 0){
+        // descend the index to the last element that is not after new, so
+        // that new goes after all the elements equal to it
+        list_inode_t *at = list_ptr->root;
+        list_node_t *after = NULL;
+        while(at != NULL){
+            if(list_ptr->comp_proc(at->node.data_ptr, new->data_ptr) != -1){
+                after = &at->node;
+                at = at->right;
+            }
+            else{
+                at = at->left;
+            }
+        }
+        new->prev = after;
+        new->next = after == NULL ? list_ptr->head : after->next;
+        if(new->prev != NULL) new->prev->next = new;
+        else list_ptr->head = new;
+        if(new->next != NULL) new->next->prev = new;
+        else list_ptr->tail = new;
+    }
+    else if(list_ptr->current_list_size == 0){ //case if the list if empty
         list_ptr->head = new; //head and tail point to new
         list_ptr->tail = new;
     }
@@ -384,10 +543,48 @@ void list_insert_sorted(list_t *list_ptr, data_t *elem_ptr)
         }
     }
 
+    if (list_ptr->indexed)
+        list_index_link(list_ptr, IX(new));
+
     /* insert your code here */
     /* the last line of this function must be the following */
     list_ptr->current_list_size++;
-    list_debug_validate(list_ptr);
+    list_check(list_ptr);
+}
+
+/* Inserts the data element into the list so that it ends up at position
+ * pos, that is, in front of the element now at pos.  A pos equal to
+ * list_size makes the element the new tail.
+ *
+ * As with list_insert the list is marked as unsorted.  For a list from
+ * list_construct_indexed this takes O(log n) time, so unlike list_insert
+ * it does not call list_debug_validate, which walks the whole list.
+ */
+void list_insert_at(list_t *list_ptr, data_t *elem_ptr, int pos)
+{
+    list_node_t *new, *after;
+
+    assert(list_ptr != NULL);
+    assert(elem_ptr != NULL);
+    assert(0 <= pos && pos <= list_ptr->current_list_size);
+
+    after = list_iter_at(list_ptr, pos);   // NULL if new becomes the tail
+    new = list_node_alloc(list_ptr);
+    new->data_ptr = elem_ptr;
+    new->next = after;
+    new->prev = after == NULL ? list_ptr->tail : after->prev;
+    if (new->prev != NULL)
+        new->prev->next = new;
+    else
+        list_ptr->head = new;
+    if (after != NULL)
+        after->prev = new;
+    else
+        list_ptr->tail = new;
+    list_ptr->current_list_size++;
+    list_ptr->list_sorted_state = UNSORTED_LIST;
+    if (list_ptr->indexed)
+        list_index_link(list_ptr, IX(new));
 }
 
 /* Removes the element from the specified list that is found at the 
@@ -430,6 +627,8 @@ data_t * list_remove(list_t *list_ptr, list_node_t * idx_ptr)
 
     list_node_t *ptr;
     data_t * ptrd; 
+    if (list_ptr->indexed && list_ptr->current_list_size > 0)
+        list_index_unlink(list_ptr, IX(idx_ptr == NULL ? list_ptr->head : idx_ptr));
     if(list_ptr->current_list_size == 0){
         return NULL;
     }
@@ -439,7 +638,7 @@ data_t * list_remove(list_t *list_ptr, list_node_t * idx_ptr)
 
         list_ptr->head = NULL;
         list_ptr->tail = NULL;
-        free(ptr);
+        list_node_release(list_ptr, ptr);
         list_ptr->current_list_size--;
         return(ptrd);
     }else if(idx_ptr == NULL || idx_ptr == list_ptr->head){
@@ -450,7 +649,7 @@ data_t * list_remove(list_t *list_ptr, list_node_t * idx_ptr)
         ptr->prev = NULL;
         ptrd = ptr->data_ptr;
 
-        free(ptr);
+        list_node_release(list_ptr, ptr);
         list_ptr->current_list_size--;
         return ptrd;
     }   
@@ -462,7 +661,7 @@ data_t * list_remove(list_t *list_ptr, list_node_t * idx_ptr)
         ptr->prev = NULL;
         ptrd = ptr->data_ptr;
 
-        free(ptr);
+        list_node_release(list_ptr, ptr);
         list_ptr->current_list_size--;
         return ptrd;
     }
@@ -474,7 +673,7 @@ data_t * list_remove(list_t *list_ptr, list_node_t * idx_ptr)
         ptr->next->prev = ptr->prev;
         ptr->prev = NULL;
         ptr->next = NULL;
-        free(ptr);
+        list_node_release(list_ptr, ptr);
         list_ptr->current_list_size--;
         return ptrd;
 
@@ -482,10 +681,522 @@ data_t * list_remove(list_t *list_ptr, list_node_t * idx_ptr)
 
     /* insert your code here */
     /* the last line should verify the list is valid after the remove */
-    list_debug_validate(list_ptr);
+    list_check(list_ptr);
     return NULL;  // you must fix the return value FIXED
 }
 
+/* Removes the element at position pos and returns a pointer to it, or
+ * returns NULL if pos is not between 0 and list_size - 1.  For a list from
+ * list_construct_indexed this takes O(log n) time.
+ */
+data_t * list_remove_at(list_t *list_ptr, int pos)
+{
+    list_node_t *n;
+
+    assert(list_ptr != NULL);
+    n = list_iter_at(list_ptr, pos);
+    if (n == NULL)
+        return NULL;
+    return list_remove(list_ptr, n);
+}
+
+/* runs list_debug_validate as often as LIST_VALIDATE asks for */
+static void list_check(list_t *L)
+{
+#if LIST_VALIDATE == LIST_VALIDATE_FULL
+    list_debug_validate(L);
+#elif LIST_VALIDATE == LIST_VALIDATE_SAMPLED
+    // not atomic; a count lost to a race only moves the next sample.
+    // Waiting for as many calls as L has elements keeps the walk O(1)
+    // amortized per call.
+    static unsigned long calls = 0;
+
+    if (++calls >= LIST_VALIDATE_EVERY
+            && calls >= (unsigned long) L->current_list_size) {
+        calls = 0;
+        list_debug_validate(L);
+    }
+#else
+    (void) L;
+#endif
+}
+
+/* ----- node allocation ----- */
+
+/* returns a node for an insert: an unused pooled node if the list has
+ * one, otherwise a new one from malloc, with room for the index if the
+ * list is indexed.  An indexed list has no pooled nodes.
+ */
+static list_node_t *list_node_alloc(list_t *L)
+{
+    list_node_t *n = L->free_nodes;
+
+    if (n != NULL) {
+        assert(!L->indexed);
+        L->free_nodes = n->next;
+        return n;
+    }
+    if (L->indexed)
+        n = (list_node_t *) malloc(sizeof(list_inode_t));
+    else
+        n = (list_node_t *) malloc(sizeof(list_node_t));
+    assert(n != NULL);
+    n->pooled = 0;
+    return n;
+}
+
+/* frees a removed node, or keeps it for reuse if it belongs to a block */
+static void list_node_release(list_t *L, list_node_t *n)
+{
+    n->prev = NULL;
+    n->data_ptr = NULL;
+    if (n->pooled) {
+        n->next = L->free_nodes;
+        L->free_nodes = n;
+    } else {
+        n->next = NULL;
+        free(n);
+    }
+}
+
+/* ----- position index for list_construct_indexed ----- */
+
+/* returns the next node priority from a xorshift generator, so the list
+ * does not disturb the rand or drand48 sequence of the caller
+ */
+static unsigned int list_index_priority(void)
+{
+    static unsigned int x = 2463534242u;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return x;
+}
+
+static int list_index_weight(list_inode_t *n)
+{
+    return n == NULL ? 0 : n->weight;
+}
+
+/* rotates x above its parent, keeping the in-order sequence of the tree */
+static void list_index_rotate_up(list_t *L, list_inode_t *x)
+{
+    list_inode_t *p = x->parent;
+    list_inode_t *g = p->parent;
+
+    if (p->left == x) {
+        p->left = x->right;
+        if (x->right != NULL)
+            x->right->parent = p;
+        x->right = p;
+    } else {
+        p->right = x->left;
+        if (x->left != NULL)
+            x->left->parent = p;
+        x->left = p;
+    }
+    p->parent = x;
+    x->parent = g;
+    if (g == NULL)
+        L->root = x;
+    else if (g->left == p)
+        g->left = x;
+    else
+        g->right = x;
+    x->weight = p->weight;
+    p->weight = 1 + list_index_weight(p->left) + list_index_weight(p->right);
+}
+
+/* adds n to the tree.  n must already be linked into the list, and its
+ * list neighbours tell where it goes: if its prev has no right child n
+ * goes there, otherwise its next is the leftmost node of that subtree and
+ * n becomes the left child of next.
+ */
+static void list_index_link(list_t *L, list_inode_t *n)
+{
+    list_inode_t *q;
+
+    n->left = NULL;
+    n->right = NULL;
+    n->weight = 1;
+    n->priority = list_index_priority();
+    if (L->root == NULL) {
+        n->parent = NULL;
+        L->root = n;
+        return;
+    }
+    if (n->node.prev != NULL && IX(n->node.prev)->right == NULL) {
+        n->parent = IX(n->node.prev);
+        n->parent->right = n;
+    } else {
+        assert(n->node.next != NULL && IX(n->node.next)->left == NULL);
+        n->parent = IX(n->node.next);
+        n->parent->left = n;
+    }
+    for (q = n->parent; q != NULL; q = q->parent)
+        q->weight++;
+    while (n->parent != NULL && n->parent->priority < n->priority)
+        list_index_rotate_up(L, n);
+}
+
+/* returns the position of n in the list */
+static int list_index_rank(list_inode_t *n)
+{
+    int rank = list_index_weight(n->left);
+
+    for (; n->parent != NULL; n = n->parent)
+        if (n->parent->right == n)
+            rank += list_index_weight(n->parent->left) + 1;
+    return rank;
+}
+
+/* splits the tree t into the first k nodes, which are returned, and the
+ * rest, which are stored in *right.  Parent links of the two roots are
+ * left to the caller.
+ */
+static list_inode_t *list_index_split(list_inode_t *t, int k, list_inode_t **right)
+{
+    list_inode_t *left;
+
+    if (t == NULL) {
+        *right = NULL;
+        return NULL;
+    }
+    if (k <= list_index_weight(t->left)) {
+        left = list_index_split(t->left, k, &t->left);
+        if (t->left != NULL)
+            t->left->parent = t;
+        *right = t;
+    } else {
+        t->right = list_index_split(t->right, k - list_index_weight(t->left) - 1, right);
+        if (t->right != NULL)
+            t->right->parent = t;
+        left = t;
+    }
+    t->weight = 1 + list_index_weight(t->left) + list_index_weight(t->right);
+    return left;
+}
+
+/* joins two trees where every node of a comes before every node of b */
+static list_inode_t *list_index_join(list_inode_t *a, list_inode_t *b)
+{
+    if (a == NULL)
+        return b;
+    if (b == NULL)
+        return a;
+    if (a->priority > b->priority) {
+        a->right = list_index_join(a->right, b);
+        a->right->parent = a;
+        a->weight = 1 + list_index_weight(a->left) + list_index_weight(a->right);
+        return a;
+    }
+    b->left = list_index_join(a, b->left);
+    b->left->parent = b;
+    b->weight = 1 + list_index_weight(b->left) + list_index_weight(b->right);
+    return b;
+}
+
+/* removes n from the tree by rotating it down until it has at most one
+ * child and then splicing it out.  The list links are not changed.
+ */
+static void list_index_unlink(list_t *L, list_inode_t *n)
+{
+    list_inode_t *child, *q;
+
+    while (n->left != NULL && n->right != NULL) {
+        if (n->left->priority > n->right->priority)
+            list_index_rotate_up(L, n->left);
+        else
+            list_index_rotate_up(L, n->right);
+    }
+    child = n->left != NULL ? n->left : n->right;
+    if (child != NULL)
+        child->parent = n->parent;
+    if (n->parent == NULL)
+        L->root = child;
+    else if (n->parent->left == n)
+        n->parent->left = child;
+    else
+        n->parent->right = child;
+    for (q = n->parent; q != NULL; q = q->parent)
+        q->weight--;
+    n->parent = NULL;
+    n->left = NULL;
+    n->right = NULL;
+}
+
+/* Moves every element of src into dst in front of the iterator position,
+ * or after the last element if idx_ptr is NULL, and leaves src empty.
+ * idx_ptr must point into dst.  The node blocks of src move with their
+ * nodes.  dst is marked as unsorted.
+ *
+ * This takes O(1) time.  If dst is indexed it takes O(log n) expected
+ * time, plus O(m log m) to index the m elements of src if src is not.
+ * The nodes of a src that is not indexed have no room for the index, so
+ * then they are copied into new nodes and iterators into src are no
+ * longer valid.  Like list_insert_at it does not call list_debug_validate.
+ */
+void list_splice(list_t *dst, list_node_t *idx_ptr, list_t *src)
+{
+    list_node_t *first, *last, *p, *next;
+    list_inode_t *x, *left, *right;
+    list_block_t *b;
+
+    assert(dst != NULL && src != NULL && dst != src);
+    if (src->current_list_size == 0)
+        return;
+    first = src->head;
+    last = src->tail;
+
+    if (dst->indexed) {
+        if (!src->indexed) {   // copy and index src the way sort does
+            src->root = NULL;
+            last = NULL;
+            for (p = first; p != NULL; p = next) {
+                next = p->next;
+                x = (list_inode_t *) malloc(sizeof(list_inode_t));
+                assert(x != NULL);
+                x->node.data_ptr = p->data_ptr;
+                x->node.prev = last;
+                x->node.next = NULL;
+                x->node.pooled = 0;
+                if (last != NULL)
+                    last->next = &x->node;
+                else
+                    first = &x->node;
+                last = &x->node;
+                list_index_link(src, x);
+                if (!p->pooled)
+                    free(p);
+            }
+        }
+        left = list_index_split(dst->root, idx_ptr == NULL ?
+                dst->current_list_size : list_index_rank(IX(idx_ptr)), &right);
+        dst->root = list_index_join(list_index_join(left, src->root), right);
+        dst->root->parent = NULL;
+    }
+
+    last->next = idx_ptr;
+    first->prev = idx_ptr == NULL ? dst->tail : idx_ptr->prev;
+    if (first->prev != NULL)
+        first->prev->next = first;
+    else
+        dst->head = first;
+    if (idx_ptr != NULL)
+        idx_ptr->prev = last;
+    else
+        dst->tail = last;
+    dst->current_list_size += src->current_list_size;
+    dst->list_sorted_state = UNSORTED_LIST;
+
+    if (src->blocks != NULL) {   // join the two circular chains
+        if (dst->blocks == NULL)
+            dst->blocks = src->blocks;
+        else {
+            b = dst->blocks->next;
+            dst->blocks->next = src->blocks->next;
+            src->blocks->next = b;
+            dst->blocks = src->blocks;
+        }
+    }
+    // unused pooled nodes of src are not carried over; their memory is in
+    // the blocks dst now owns and is freed with them
+
+    src->head = NULL;
+    src->tail = NULL;
+    src->root = NULL;
+    src->current_list_size = 0;
+    src->free_nodes = NULL;
+    src->blocks = NULL;
+}
+
+/* Moves every element of src to the end of dst and leaves src empty */
+void list_concat(list_t *dst, list_t *src)
+{
+    list_splice(dst, NULL, src);
+}
+
+/* ----- merge sort ----- */
+
+/* During a sort the nodes are chained through next only and each chain
+ * ends with NULL; prev is repaired once at the end.
+ */
+
+/* cuts the run that starts at head off the rest of the chain and returns
+ * the start of the next run.  A run is a stretch in order, or a stretch in
+ * strictly reverse order, which is reversed in place; reversing is stable
+ * only because no two of its elements are equal.  *run is set to the
+ * first node of the run in order.
+ */
+static list_node_t *list_cut_run(list_node_t *head, list_node_t **run,
+        int (*fcomp)(const data_t *, const data_t *))
+{
+    list_node_t *p = head, *rest, *rev, *next;
+
+    if (p->next != NULL && fcomp(p->data_ptr, p->next->data_ptr) == -1) {
+        while (p->next != NULL && fcomp(p->data_ptr, p->next->data_ptr) == -1)
+            p = p->next;
+        rest = p->next;
+        rev = NULL;
+        for (p = head; p != rest; p = next) {
+            next = p->next;
+            p->next = rev;
+            rev = p;
+        }
+        *run = rev;
+        return rest;
+    }
+    while (p->next != NULL && fcomp(p->data_ptr, p->next->data_ptr) != -1)
+        p = p->next;
+    rest = p->next;
+    p->next = NULL;
+    *run = head;
+    return rest;
+}
+
+/* merges chains a and b, taking from a when elements are equal so that the
+ * merge is stable, and returns the merged chain
+ */
+static list_node_t *list_merge_chains(list_node_t *a, list_node_t *b,
+        int (*fcomp)(const data_t *, const data_t *))
+{
+    list_node_t head;
+    list_node_t *t = &head;
+
+    while (a != NULL && b != NULL) {
+        if (fcomp(a->data_ptr, b->data_ptr) != -1) {
+            t->next = a;
+            a = a->next;
+        } else {
+            t->next = b;
+            b = b->next;
+        }
+        t = t->next;
+    }
+    t->next = a != NULL ? a : b;
+    return head.next;
+}
+
+/* natural bottom-up merge sort of a NULL terminated chain.  The chain is
+ * cut into the runs that are already in order, and the runs are merged
+ * like a binary counter: bin[k] holds the merge of 2^k runs, and each new
+ * run is carried up through the full bins.  Each merge then works on nodes
+ * that were visited recently, instead of every pass walking the whole
+ * chain.  A bin always holds elements from before the carry, so it is the
+ * left side of every merge and the sort is stable.
+ */
+#define LIST_SORT_BINS 64
+static list_node_t *list_merge_sort(list_node_t *head,
+        int (*fcomp)(const data_t *, const data_t *))
+{
+    list_node_t *bin[LIST_SORT_BINS];
+    list_node_t *run;
+    int k, used = 0;
+
+    while (head != NULL) {
+        head = list_cut_run(head, &run, fcomp);
+        for (k = 0; k < used && bin[k] != NULL; k++) {
+            run = list_merge_chains(bin[k], run, fcomp);
+            bin[k] = NULL;
+        }
+        if (k == used)
+            used++;
+        assert(used <= LIST_SORT_BINS);
+        bin[k] = run;
+    }
+    run = NULL;
+    for (k = 0; k < used; k++)
+        if (bin[k] != NULL)
+            run = run == NULL ? bin[k] : list_merge_chains(bin[k], run, fcomp);
+    return run;
+}
+
+/* one piece of a SORT_MERGE_PARALLEL sort */
+typedef struct {
+    list_node_t *head;
+    int (*fcomp)(const data_t *, const data_t *);
+} list_sort_job_t;
+
+static void *list_sort_worker(void *arg)
+{
+    list_sort_job_t *job = (list_sort_job_t *) arg;
+    job->head = list_merge_sort(job->head, job->fcomp);
+    return NULL;
+}
+
+/* cuts the list into LIST_SORT_THREADS chains of nearly equal length,
+ * sorts all but the first on new threads and the first on this one, and
+ * merges the sorted chains left to right so that the result is stable.
+ * Falls back to sorting on this thread if a thread cannot be created.
+ */
+static list_node_t *list_parallel_sort(list_t *L,
+        int (*fcomp)(const data_t *, const data_t *))
+{
+    list_sort_job_t jobs[LIST_SORT_THREADS];
+    pthread_t threads[LIST_SORT_THREADS];
+    int started[LIST_SORT_THREADS];
+    list_node_t *p = L->head, *head, *tail;
+    int pieces = LIST_SORT_THREADS;
+    int i, k, len;
+
+    if (L->current_list_size < 2*pieces)
+        return list_merge_sort(L->head, fcomp);
+    for (i = 0; i < pieces; i++) {
+        len = L->current_list_size/pieces + (i < L->current_list_size % pieces);
+        jobs[i].head = p;
+        jobs[i].fcomp = fcomp;
+        for (k = 1; k < len; k++)
+            p = p->next;
+        tail = p;
+        p = p->next;
+        tail->next = NULL;
+    }
+    for (i = 1; i < pieces; i++)
+        started[i] = pthread_create(&threads[i], NULL, list_sort_worker, &jobs[i]) == 0;
+    list_sort_worker(&jobs[0]);
+    for (i = 1; i < pieces; i++) {
+        if (started[i])
+            pthread_join(threads[i], NULL);
+        else
+            list_sort_worker(&jobs[i]);
+    }
+    head = jobs[0].head;
+    for (i = 1; i < pieces; i++)
+        head = list_merge_chains(head, jobs[i].head, fcomp);
+    return head;
+}
+
+/* Sorts the list in place with a stable merge sort that relinks the nodes.
+ * sort_type is SORT_MERGE or SORT_MERGE_PARALLEL.  fcomp becomes the
+ * comparison procedure of the list, which is marked as sorted, so
+ * list_insert_sorted can be used afterwards.  Takes O(n log n) time,
+ * against O(n^2) for building the same list with list_insert_sorted.
+ */
+void sort(list_t *list_ptr, int sort_type, int (*fcomp)(const data_t *, const data_t *))
+{
+    list_node_t *p, *prev = NULL;
+
+    assert(list_ptr != NULL && fcomp != NULL);
+    assert(sort_type == SORT_MERGE || sort_type == SORT_MERGE_PARALLEL);
+    if (sort_type == SORT_MERGE_PARALLEL)
+        list_ptr->head = list_parallel_sort(list_ptr, fcomp);
+    else
+        list_ptr->head = list_merge_sort(list_ptr->head, fcomp);
+
+    // repair prev, the tail, and the position index for the new order
+    list_ptr->root = NULL;
+    for (p = list_ptr->head; p != NULL; p = p->next) {
+        p->prev = prev;
+        if (list_ptr->indexed)
+            list_index_link(list_ptr, IX(p));
+        prev = p;
+    }
+    list_ptr->tail = prev;
+    list_ptr->comp_proc = fcomp;
+    list_ptr->list_sorted_state = SORTED_LIST;
+    list_check(list_ptr);
+}
+
 /* Obtains the length of the specified list, that is, the number of elements
  * that the list contains.
  *
@@ -5,22 +5,78 @@
  * Public functions for two-way linked list
  */
 
+#ifdef LIST_UNROLLED
+/* Unrolled representation from ulist.c, selected by compiling with
+ * -DLIST_UNROLLED.  The list is a two-way linked list of chunks, and each
+ * chunk holds up to LIST_CHUNK_SLOTS data pointers in order, so a walk
+ * touches one cache line per eight elements instead of one node per
+ * element.  Chunks are LIST_CHUNK_BYTES long and aligned to that size,
+ * which lets an iterator be a plain pointer to a slot: the chunk that
+ * holds a slot is found by clearing the low bits of its address.
+ *
+ * Inserting or removing an element moves the other elements of its chunk,
+ * so any iterator other than the one returned by the call is invalid
+ * afterwards.
+ */
+#define LIST_CHUNK_BYTES 256
+#define LIST_CHUNK_SLOTS \
+    ((LIST_CHUNK_BYTES - 2*sizeof(void *) - sizeof(int)) / sizeof(data_t *))
+
+typedef data_t * list_node_t;    // one slot of a chunk
+
+typedef struct list_chunk_tag {
+    // private members for ulist.c only
+    struct list_chunk_tag *prev;
+    struct list_chunk_tag *next;
+    int count;                   // slots in use, always slot[0] to slot[count-1]
+    data_t *slot[LIST_CHUNK_SLOTS];
+} list_chunk_t;
+
+typedef struct list_tag {
+    // private members for ulist.c only
+    list_chunk_t *head;
+    list_chunk_t *tail;
+    int current_list_size;
+    int list_sorted_state;
+    // Private procedure for ulist.c only
+    int (*comp_proc)(const data_t *, const data_t *);
+} list_t;
+#else
 typedef struct list_node_tag {
     // private members for list.c only
     data_t *data_ptr;
     struct list_node_tag *prev;
     struct list_node_tag *next;
+    char pooled;                 // node is in a block from list_from_array
 } list_node_t;
 
+/* node of a list from list_construct_indexed: the list node followed by
+ * its place in the position index, so other lists do not pay for it
+ */
+typedef struct list_inode_tag {
+    // private members for list.c only
+    list_node_t node;            // must be first
+    struct list_inode_tag *parent;
+    struct list_inode_tag *left;
+    struct list_inode_tag *right;
+    int weight;                  // number of nodes in this subtree
+    unsigned int priority;       // heap order that keeps the tree balanced
+} list_inode_t;
+
 typedef struct list_tag {
     // private members for list.c only
     list_node_t *head;
     list_node_t *tail;
     int current_list_size;
     int list_sorted_state;
+    int indexed;                 // nonzero if root indexes the nodes by position
+    list_inode_t *root;
+    list_node_t *free_nodes;     // unused pooled nodes, chained through next
+    struct list_block_tag *blocks;   // node blocks owned by this list
     // Private procedure for list.c only
     int (*comp_proc)(const data_t *, const data_t *);
 } list_t;
+#endif
 
 /* public definition of pointer into linked list */
 typedef list_node_t * IteratorPtr;
@@ -30,12 +86,15 @@ typedef list_t * ListPtr;
 
 /* build and cleanup lists */
 ListPtr list_construct(int (*fcomp)(const data_t *, const data_t *));
+ListPtr list_construct_indexed(int (*fcomp)(const data_t *, const data_t *));
+ListPtr list_from_array(data_t **elems, int n);
 void list_destruct(ListPtr list_ptr);
 
 /* iterators into positions in the list */
 IteratorPtr list_iter_front(ListPtr list_ptr);
 IteratorPtr list_iter_back(ListPtr list_ptr);
 IteratorPtr list_iter_next(IteratorPtr idx_ptr);
+IteratorPtr list_iter_at(ListPtr list_ptr, int pos);
 
 data_t * list_access(ListPtr list_ptr, IteratorPtr idx_ptr);
 IteratorPtr list_elem_find(ListPtr list_ptr, data_t *elem_ptr,
@@ -43,13 +102,44 @@ IteratorPtr list_elem_find(ListPtr list_ptr, data_t *elem_ptr,
 
 void list_insert(ListPtr list_ptr, data_t *elem_ptr, IteratorPtr idx_ptr);
 void list_insert_sorted(ListPtr list_ptr, data_t *elem_ptr);
+void list_insert_at(ListPtr list_ptr, data_t *elem_ptr, int pos);
 
 data_t * list_remove(ListPtr list_ptr, IteratorPtr idx_ptr);
+data_t * list_remove_at(ListPtr list_ptr, int pos);
+
+/* move every element of src into dst; src is left empty */
+void list_splice(ListPtr dst, IteratorPtr idx_ptr, ListPtr src);
+void list_concat(ListPtr dst, ListPtr src);
 
 int list_size(ListPtr list_ptr);
 
+/* sort_type values for sort.  Both are stable O(n log n) merge sorts;
+ * SORT_MERGE_PARALLEL splits the list into LIST_SORT_THREADS pieces that
+ * are sorted on their own threads and then merged.  fcomp must be safe to
+ * call from several threads at once.
+ */
+#define SORT_MERGE          1
+#define SORT_MERGE_PARALLEL 2
+#define LIST_SORT_THREADS   4
 void sort(ListPtr list_ptr, int sort_type, int (*fcomp)(const data_t *, const data_t *));
 void waitinsert(ListPtr list_ptr, int eth, int access);
 
+/* how often the list functions run list_debug_validate, which walks the
+ * whole list.  Set LIST_VALIDATE with -D when compiling list.c or ulist.c.
+ * LIST_VALIDATE_SAMPLED validates after LIST_VALIDATE_EVERY calls,
+ * counted over all lists, or after as many calls as the list has elements
+ * if that is more, so a bug is still caught soon after it happens and the
+ * walk costs O(1) amortized per call.
+ */
+#define LIST_VALIDATE_OFF     0
+#define LIST_VALIDATE_SAMPLED 1
+#define LIST_VALIDATE_FULL    2
+#ifndef LIST_VALIDATE
+#define LIST_VALIDATE LIST_VALIDATE_FULL
+#endif
+#ifndef LIST_VALIDATE_EVERY
+#define LIST_VALIDATE_EVERY 1024
+#endif
+
 /* commands for vim. ts: tabstop, sts: soft tabstop sw: shiftwidth */
 /* vi:set ts=8 sts=4 sw=4 et: */
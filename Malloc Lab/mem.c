@@ -6,18 +6,94 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <stdint.h>
+#include <string.h>
 #include <assert.h>
 #include <unistd.h>
+#include <sys/mman.h>
 
 #include "mem.h"
 
 static mchunk_t DummyChunk = {&DummyChunk,&DummyChunk, 0};
+static mchunk_t ShortDummyChunk = {&ShortDummyChunk,&ShortDummyChunk, 0};
 static mchunk_t * Rover = &DummyChunk;   // one time initialization
 static int NumSbrkCalls = 0;
-static int NumPages = 0;
+static int NumHugeCalls = 0;   // morecore calls served from huge page reservations
+static size_t NumPages = 0;
+static size_t PeakPages = 0;
+static size_t NumTrimmedPages = 0;
+
+/* With HugePages, morecore hands out pages from the top of a reservation
+ * the same way sbrk moves the program break: HugeBrk is the first byte not
+ * yet in the heap and HugeEnd is the end of the reservation.  Reservations
+ * start on a 2 MiB boundary and are at least MEM_HUGE_RESERVE bytes, so
+ * heap growth fills whole huge pages.
+ */
+#define MEM_HUGE_PAGESIZE ((size_t) 2 << 20)
+#define MEM_HUGE_RESERVE ((size_t) 64 << 20)
+static char *HugeBrk = NULL;
+static char *HugeEnd = NULL;
+static int NumHugeReserves = 0;
+
+/* Arena 0 is the free list used by Mem_alloc.  Arena 1 holds the blocks of
+ * Mem_alloc_tagged sites that have been learned to be short lived, in pages
+ * of its own.  The allocator always works on the active arena through
+ * Rover; mem_set_arena saves Rover and loads the rover of the other list.
+ */
+#define MEM_ARENAS 2
+#define SHORT_ARENA 1
+static mchunk_t *ArenaDummy[MEM_ARENAS] = {&DummyChunk, &ShortDummyChunk};
+static mchunk_t *ArenaRover[MEM_ARENAS] = {&DummyChunk, &ShortDummyChunk};
+static int Arena = 0;
+
+/* lifetime record for one Mem_alloc_tagged call site.  Slot 0 is never
+ * used so that a site of 0 in a block header means untagged.
+ */
+#define MEM_MAX_SITES 256
+#define MEM_SITE_SAMPLES 8          // frees needed before a site is classified
+#define MEM_SHORT_LIFETIME 1024     // mean lifetime, in allocations, of a short lived site
+typedef struct {
+    unsigned long id;       // site_id from Mem_alloc_tagged, 0 if slot unused
+    double avg_lifetime;    // running mean of the lifetimes seen at Mem_free
+    int frees;              // number of lifetimes seen
+} msite_t;
+
+static msite_t Sites[MEM_MAX_SITES];
+static unsigned int AllocClock = 0;    // number of blocks handed out so far
+
+/* a contiguous piece of the heap obtained with morecore.  Pages from
+ * back-to-back sbrk calls are merged into one region, so every block in a
+ * region, free or allocated, is found by stepping p = p + p->size from the
+ * region start.  Kept in address order.
+ */
+typedef struct {
+    mchunk_t *start;
+    mchunk_t *end;
+    int arena;           // blocks in a region all belong to one arena
+} mregion_t;
+
+static mregion_t *Regions = NULL;
+static int NumRegions = 0;
+static int MaxRegions = 0;
+
+/* one slot per handle from Mem_halloc.  Slot 0 is never used so that
+ * MEM_NULL_HANDLE can be returned on failure.
+ */
+typedef struct {
+    mchunk_t *block;     // header of the block, NULL if the slot is unused
+    int lock_count;      // block can only be moved when this is zero
+    int next_free;       // next unused slot, only valid if block is NULL
+} mhandle_slot_t;
+
+static mhandle_slot_t *Handles = NULL;
+static int NumHandleSlots = 0;
+static int FreeHandle = MEM_NULL_HANDLE;
 
 // private function prototypes
 void mem_validate(void);
+void mem_add_region(mchunk_t *start, size_t new_bytes);
+void mem_trim(void);
+static char *mem_huge_more(size_t new_bytes);
 
 /* function to request 1 or more pages from the operating system.
  *
@@ -34,7 +110,7 @@ void mem_validate(void);
  * You can update this function to match your design.  But the method
  * to test sbrk much not be changed.  
  */
-mchunk_t *morecore(int new_bytes) 
+mchunk_t *morecore(size_t new_bytes) 
 {
     char *cp;
     mchunk_t *new_p;
@@ -42,16 +118,210 @@ mchunk_t *morecore(int new_bytes)
     assert(new_bytes > 0);
     assert(new_bytes % PAGESIZE == 0);
     assert(PAGESIZE % sizeof(mchunk_t) == 0);
-    cp = sbrk(new_bytes);
+    if (new_bytes > INTPTR_MAX)  /* sbrk takes a signed increment */
+        return NULL;
+    if (HugePages)
+        cp = mem_huge_more(new_bytes);
+    else
+        cp = sbrk((intptr_t) new_bytes);
     if (cp == (char *) -1)  /* no space available */
         return NULL;
     new_p = (mchunk_t *) cp;
     // You should add some code to count the number of calls
     // to sbrk, and the number of pages that have been requested
-    NumSbrkCalls++; NumPages += new_bytes/PAGESIZE;
+    if (HugePages)
+        NumHugeCalls++;
+    else
+        NumSbrkCalls++;
+    NumPages += new_bytes/PAGESIZE;
+    if (NumPages > PeakPages)
+        PeakPages = NumPages;
+    mem_add_region(new_p, new_bytes);
     return new_p;
 }
 
+/* the HugePages version of sbrk.  Returns new_bytes from the current
+ * reservation, or maps a new one if they do not fit.  The unused end of
+ * the old reservation is unmapped, since the heap can only grow from the
+ * newest one.  Returns (char *) -1 if mmap fails.
+ */
+static char *mem_huge_more(size_t new_bytes)
+{
+    char *cp, *base;
+    size_t reserve, lead;
+
+    if (HugeBrk == NULL || (size_t) (HugeEnd - HugeBrk) < new_bytes) {
+        reserve = MEM_HUGE_RESERVE;
+        if (new_bytes > reserve)
+            reserve = (new_bytes + MEM_HUGE_PAGESIZE - 1) / MEM_HUGE_PAGESIZE
+                * MEM_HUGE_PAGESIZE;
+        // map one extra huge page so an aligned start can be cut out of it
+        cp = mmap(NULL, reserve + MEM_HUGE_PAGESIZE, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (cp == MAP_FAILED)
+            return (char *) -1;
+        lead = (MEM_HUGE_PAGESIZE - (uintptr_t) cp % MEM_HUGE_PAGESIZE)
+            % MEM_HUGE_PAGESIZE;
+        base = cp + lead;
+        if (lead > 0)
+            munmap(cp, lead);
+        munmap(base + reserve, MEM_HUGE_PAGESIZE - lead);
+        madvise(base, reserve, MADV_HUGEPAGE);  // only a hint, ignore failure
+        if (HugeBrk != NULL && HugeEnd > HugeBrk)
+            munmap(HugeBrk, HugeEnd - HugeBrk);
+        HugeBrk = base;
+        HugeEnd = base + reserve;
+        NumHugeReserves++;
+    }
+    cp = HugeBrk;
+    HugeBrk += new_bytes;
+    return cp;
+}
+
+/* record new_bytes of heap starting at start for the active arena.  If the
+ * new pages continue a region of the same arena that region is extended
+ * instead.  A new mmap reservation can land just below an older one, so the
+ * region that follows is checked too.
+ */
+void mem_add_region(mchunk_t *start, size_t new_bytes)
+{
+    mchunk_t *end = start + new_bytes/sizeof(mchunk_t);
+    int i;
+
+    for (i = NumRegions; i > 0 && Regions[i-1].start > start; i--)
+        ;   // i is the position that keeps Regions in address order
+    if (i > 0 && Regions[i-1].end == start && Regions[i-1].arena == Arena) {
+        Regions[i-1].end = end;
+        if (i < NumRegions && Regions[i].start == end && Regions[i].arena == Arena) {
+            Regions[i-1].end = Regions[i].end;
+            memmove(Regions + i, Regions + i + 1, (NumRegions - i - 1)*sizeof(mregion_t));
+            NumRegions--;
+        }
+        return;
+    }
+    if (i < NumRegions && Regions[i].start == end && Regions[i].arena == Arena) {
+        Regions[i].start = start;
+        return;
+    }
+    if (NumRegions == MaxRegions) {
+        MaxRegions = MaxRegions == 0 ? 16 : 2*MaxRegions;
+        Regions = (mregion_t *) realloc(Regions, MaxRegions*sizeof(mregion_t));
+        assert(Regions != NULL);
+    }
+    memmove(Regions + i + 1, Regions + i, (NumRegions - i)*sizeof(mregion_t));
+    Regions[i].start = start;
+    Regions[i].end = end;
+    Regions[i].arena = Arena;
+    NumRegions++;
+}
+
+/* makes arena the active free list
+ */
+static void mem_set_arena(int arena)
+{
+    ArenaRover[Arena] = Rover;
+    Arena = arena;
+    Rover = ArenaRover[arena];
+}
+
+/* returns the number of units for a block that holds nbytes, including
+ * one unit for the header, or 0 if the block would not fit in the address
+ * space
+ */
+static size_t mem_units(const size_t nbytes)
+{
+    size_t units;
+    if (nbytes > SIZE_MAX - 2*sizeof(mchunk_t))
+        return 0;
+    units = nbytes / sizeof(mchunk_t) + 1;
+    if (nbytes % sizeof(mchunk_t))
+        units++;
+    return units;
+}
+
+/* returns n blocks of units each, or 0 if the product overflows */
+static size_t mem_units_times(size_t units, size_t n)
+{
+    if (units != 0 && n > SIZE_MAX / units)
+        return 0;
+    return units * n;
+}
+
+/* returns the bytes in the smallest whole number of pages that holds units,
+ * or 0 if that is more than a size_t can count
+ */
+static size_t mem_page_bytes(size_t units)
+{
+    size_t bytes;
+    if (units == 0 || units > (SIZE_MAX - PAGESIZE) / sizeof(mchunk_t))
+        return 0;
+    bytes = units * sizeof(mchunk_t);
+    if (bytes % PAGESIZE != 0)
+        bytes = PAGESIZE * (bytes / PAGESIZE) + PAGESIZE;
+    return bytes;
+}
+
+/* runs the search policy over the active free list starting at Rover.
+ * Returns a free block with at least units units and leaves Rover pointing
+ * at it, or returns NULL if no block is large enough.
+ */
+static mchunk_t *mem_find_fit(size_t units)
+{
+    mchunk_t *p = Rover;
+    assert(units > 1);
+    mchunk_t *best = NULL;
+    do {
+        if (p->size >= units) {
+            if (SearchPolicy != BEST_FIT || p->size == units) {
+                best = p;
+                break;
+            }
+            if (best == NULL || p->size < best->size)
+                best = p;
+        }
+        p = p->next;
+    } while (p != Rover);
+    if (best != NULL)
+        Rover = best;
+    return best;
+}
+
+/* returns the Sites slot for site_id, claiming a free slot the first time
+ * an id is seen.  Returns 0 (untagged) if site_id is 0 or the table is full.
+ */
+static int mem_site_lookup(unsigned long site_id)
+{
+    int i, probes;
+    if (site_id == 0)
+        return 0;
+    i = site_id % (MEM_MAX_SITES - 1) + 1;
+    for (probes = 1; probes < MEM_MAX_SITES; probes++) {
+        if (Sites[i].id == site_id)
+            return i;
+        if (Sites[i].id == 0) {
+            Sites[i].id = site_id;
+            Sites[i].avg_lifetime = 0.0;
+            Sites[i].frees = 0;
+            return i;
+        }
+        i = i % (MEM_MAX_SITES - 1) + 1;   // slots 1 to MEM_MAX_SITES-1
+    }
+    return 0;
+}
+
+/* adds the lifetime of block p to the running mean of its site.  The mean
+ * is weighted towards recent frees once a site has enough history, so a
+ * site that changes behavior is reclassified.
+ */
+static void mem_site_free(mchunk_t *p)
+{
+    msite_t *site = &Sites[p->site];
+    double lifetime = AllocClock - p->birth;   // unsigned, so wrap around is harmless
+    int weight = site->frees < 32 ? site->frees + 1 : 32;
+    site->avg_lifetime += (lifetime - site->avg_lifetime)/weight;
+    site->frees++;
+}
+
 /* deallocates the space pointed to by return_ptr; it does nothing if
  * return_ptr is NULL.  
  *
@@ -65,6 +335,16 @@ void Mem_free(void *return_ptr)
 
     mchunk_t *p = ((mchunk_t *)return_ptr); //new pointer that points to the start of the block
     p = p - 1;
+    if(p->arena != Arena){ //block belongs to the other free list
+        int active = Arena;
+        mem_set_arena(p->arena);
+        Mem_free(return_ptr);
+        mem_set_arena(active);
+        return;
+    }
+    if(p->site != 0){
+        mem_site_free(p);
+    }
     if(Coalescing != TRUE){
         p->next = Rover->next;
         Rover->next = p;
@@ -138,92 +418,39 @@ void Mem_free(void *return_ptr)
  * This function assumes that there is a Rover pointer that points to
  * some item in the free list.  
  */
-void *Mem_alloc(const int nbytes)
+void *Mem_alloc(const size_t nbytes)
 {
     // precondition
     assert(nbytes > 0);
     assert(Rover != NULL && Rover->next != NULL && Rover->prev != NULL);
 
-    mchunk_t *start = Rover; //start
-    mchunk_t *roverPrev;
-    mchunk_t *temp = Rover; //temp variable
+    mchunk_t *temp; //temp variable
 
     mchunk_t *p = NULL;
     mchunk_t *q = NULL;
 
-    mchunk_t *Brover = NULL;
-    mchunk_t *BroverPrev = NULL;
-
     mchunk_t *MoreChunk;
-    Rover = Rover->next;
-    int ChunksNum;
-    int Units;
-    Units = nbytes / sizeof(mchunk_t) + 1;
-    if(nbytes % sizeof(mchunk_t)){
-        Units++;
-    }
-
-    if(SearchPolicy == BEST_FIT) { //best fit policy
-        roverPrev = Rover; //sets roverPrev
-        Rover = Rover->next;
-        start = Rover;
-
-        do{
-            if(Rover->size == Units){ //confirms size of the rover
-                Brover = Rover;
-                BroverPrev = roverPrev; 
-                break;
-            }
-            if((Rover->size >= Units) && (Rover->size < Brover->size || Brover == NULL)){
-                Brover = Rover;
-                BroverPrev = roverPrev;
-            }
-            roverPrev = Rover;
-            Rover = Rover->next; //moves through list
-        }
-        while(Rover != start);
-            if(Brover != NULL){ //searches for value in list
-                Rover = Brover; 
-                roverPrev = BroverPrev;
-                p = Brover; //sets p and q
-                q = p + 1; //sets q
-                Brover = NULL;
-                BroverPrev = NULL; //used segment in MP4 file as help
-            }
-            else{
-                q = NULL;
-            }
-    }
-    else{ //first fit policy
-        roverPrev = Rover; //sets roverPrev
-        Rover = Rover->next;
-        start = Rover;
-        do{
-            p = Rover; //sets p and q
-            if(Rover->size >= Units){ //find first spot that has enough space
-                q = p + 1; //sets q
-                break;
-            }
-            roverPrev = Rover;
-            Rover = Rover->next; //moves through list
-        }
-        while(Rover != start);
+    size_t ChunksNum;
+    size_t Units;
+    Units = mem_units(nbytes);
+    if(Units == 0){ //request is larger than the address space
+        return NULL;
     }
 
-    if(q == NULL){
-        p = NULL;
-    }
+    p = mem_find_fit(Units); //runs the search policy, leaves Rover at p
 
     if(p == NULL){ //incase there is no fit
-        ChunksNum = (nbytes + sizeof(mchunk_t));
-        if(ChunksNum % PAGESIZE != 0){ //checks for valid size
-            ChunksNum = PAGESIZE * (ChunksNum / PAGESIZE) + PAGESIZE;
+        ChunksNum = mem_page_bytes(Units); //whole pages that hold the block
+        if(ChunksNum == 0){
+            return NULL;
         }
         MoreChunk = morecore(ChunksNum); //more memory
         if(MoreChunk == NULL){ //incase morecore does not allocate more memory
             return NULL; 
         }
         MoreChunk->size = ChunksNum/sizeof(mchunk_t);
+        MoreChunk->site = 0;
+        MoreChunk->arena = Arena;
         Mem_free(MoreChunk + 1); //frees excess memory
 
         return Mem_alloc(nbytes); //returns correctly allocated memory
@@ -248,6 +475,9 @@ void *Mem_alloc(const int nbytes)
         q = p + 1; //sets q
     }
  
+    p->birth = AllocClock++;
+    p->site = 0;
+    p->arena = Arena;
     assert((p->size - 1)*sizeof(mchunk_t) >= nbytes);
     assert((p->size - 1)*sizeof(mchunk_t) < nbytes + 2*sizeof(mchunk_t));
     return q; 
@@ -282,46 +512,232 @@ void *Mem_alloc(const int nbytes)
     //return malloc(nbytes);
 }
 
+/* returns a pointer to space for an object of size nbytes from the arena
+ * chosen for site_id.  The site is recorded in the block header so that
+ * Mem_free can update the lifetime of the site.
+ */
+void *Mem_alloc_tagged(const size_t nbytes, unsigned long site_id)
+{
+    int site = mem_site_lookup(site_id);
+    int active = Arena;
+    void *q;
+
+    if (site != 0 && Sites[site].frees >= MEM_SITE_SAMPLES
+            && Sites[site].avg_lifetime < MEM_SHORT_LIFETIME)
+        mem_set_arena(SHORT_ARENA);
+    q = Mem_alloc(nbytes);
+    mem_set_arena(active);
+    if (q != NULL)
+        (((mchunk_t *) q) - 1)->site = site;
+    return q;
+}
+
+/* Fills out[0] to out[count-1] with blocks of nbytes each and returns how
+ * many were allocated, which is less than count only if morecore fails.
+ *
+ * The search policy is first run once for the whole batch.  If a free
+ * block can hold every block in the batch they are all carved from its end
+ * in one pass.  Otherwise blocks are carved from each free block the policy
+ * finds for one block, and whatever is left comes from a single morecore
+ * call.
+ */
+int Mem_alloc_batch(const size_t nbytes, int count, void **out)
+{
+    // precondition
+    assert(nbytes > 0 && count >= 0 && (count == 0 || out != NULL));
+    assert(Rover != NULL && Rover->next != NULL && Rover->prev != NULL);
+
+    size_t units = mem_units(nbytes);
+    size_t batch_units;
+    size_t new_bytes;
+    int done = 0;
+    mchunk_t *p = NULL, *q;
+
+    if (units == 0)
+        return 0;
+    batch_units = mem_units_times(units, count);
+    if (count > 1 && batch_units != 0)
+        p = mem_find_fit(batch_units);
+    while (done < count) {
+        if (p == NULL)
+            p = mem_find_fit(units);
+        if (p == NULL) {   // no fit at all, one morecore for the rest
+            new_bytes = mem_page_bytes(mem_units_times(units, count - done));
+            if (new_bytes == 0)   // too big for one call, take one block
+                new_bytes = mem_page_bytes(units);
+            if (new_bytes == 0 || (p = morecore(new_bytes)) == NULL)
+                break;
+            p->size = new_bytes/sizeof(mchunk_t);
+            p->site = 0;
+            p->arena = Arena;
+            Mem_free(p + 1);
+            p = mem_find_fit(units);
+            continue;
+        }
+        while (done < count && p->size > units + 1) {   // carve from the end
+            p->size -= units;
+            q = p + p->size;
+            q->size = units;
+            q->next = NULL;
+            q->prev = NULL;
+            q->birth = AllocClock++;
+            q->site = 0;
+            q->arena = Arena;
+            out[done++] = q + 1;
+        }
+        if (done < count && p->size >= units) {   // last one takes the whole block
+            assert(p == Rover);
+            p->prev->next = p->next;
+            p->next->prev = p->prev;
+            Rover = p->next;
+            p->next = NULL;
+            p->prev = NULL;
+            p->birth = AllocClock++;
+            p->site = 0;
+            p->arena = Arena;
+            out[done++] = p + 1;
+        }
+        p = NULL;
+    }
+    return done;
+}
+
+/* qsort comparison to order block pointers by address */
+static int mem_ptr_cmp(const void *a, const void *b)
+{
+    const char *pa = *(char * const *) a;
+    const char *pb = *(char * const *) b;
+    return (pa > pb) - (pa < pb);
+}
+
+/* Returns n blocks to the free list.  NULL entries are skipped.  The
+ * array is sorted by address as a side effect.
+ *
+ * With coalescing, the blocks are sorted and merged into the address
+ * ordered free list in one sweep: the insertion point for each block is
+ * found by moving forward from the insertion point of the block before it,
+ * so the whole batch costs one pass over the free list.  Blocks that end
+ * up next to each other are joined on the way.
+ */
+void Mem_free_batch(void **ptrs, int n)
+{
+    // precondition
+    assert(n >= 0 && (n == 0 || ptrs != NULL));
+    assert(Rover != NULL && Rover->next != NULL && Rover->prev != NULL);
+
+    mchunk_t *dummy = ArenaDummy[Arena];
+    mchunk_t *left = dummy;    // last free block in front of p
+    mchunk_t *right;
+    mchunk_t *p;
+    int i;
+
+    if (Coalescing != TRUE) {   // order does not matter without coalescing
+        for (i = 0; i < n; i++)
+            if (ptrs[i] != NULL)
+                Mem_free(ptrs[i]);
+        return;
+    }
+    qsort(ptrs, n, sizeof(void *), mem_ptr_cmp);
+    for (i = 0; i < n; i++) {
+        if (ptrs[i] == NULL)
+            continue;
+        p = ((mchunk_t *) ptrs[i]) - 1;
+        if (p->arena != Arena) {   // belongs to the other free list
+            Rover = left;
+            Mem_free(ptrs[i]);
+            continue;
+        }
+        if (p->site != 0)
+            mem_site_free(p);
+        while (left->next != dummy && left->next < p)
+            left = left->next;
+        right = left->next;
+
+        if (left != dummy && left + left->size == p) {   // join with left
+            left->size += p->size;
+            p->next = NULL;
+            p->prev = NULL;
+            p->size = 0;
+            p = left;
+        } else {
+            p->prev = left;
+            p->next = right;
+            left->next = p;
+            right->prev = p;
+        }
+        if (right != dummy && p + p->size == right) {   // join with right
+            p->size += right->size;
+            p->next = right->next;
+            p->next->prev = p;
+            right->next = NULL;
+            right->prev = NULL;
+            right->size = 0;
+        }
+        left = p;
+    }
+    Rover = left;
+}
+
 /* prints stats about the current free list
  *
  * -- number of items in the linked list including dummy item
  * -- min, max, and average size of each item (in bytes) except dummy
  * -- total memory in list (in bytes) except dummy
- * -- number of calls to sbrk and number of pages requested
+ * -- number of calls to sbrk, and to morecore with HugePages, and number
+ *    of pages requested
  *
  * A message is printed if all the memory is in the free list
  */
 void Mem_stats(void)
 {
-    int NumItems = -1; //keeps track of num of items and accounts for dummy
-    int average; //keeps track of the average memory used in the list
-    int min; //max memory walue
-    int max; //min memory value
-    int M = 0; //keeps track of the total memory in the list
-
-    mchunk_t *starter = Rover; //used to run through the list
-    do{
-        if (Rover->size > max){
-            max = Rover->size;
+    int NumItems = 0; //keeps track of num of items, dummies are not counted
+    size_t average = 0; //keeps track of the average memory used in the list
+    size_t min = 0; //max memory walue
+    size_t max = 0; //min memory value
+    size_t M = 0; //keeps track of the total memory in the list
+    int ShortItems = 0; //items and memory in the short-lived arena
+    size_t ShortM = 0;
+    int a;
+
+    for (a = 0; a < MEM_ARENAS; a++){ //both arenas count towards the heap
+        mchunk_t *p = ArenaDummy[a]->next; //used to run through the list
+        while (p != ArenaDummy[a]){
+            if (p->size > max){
+                max = p->size;
+            }
+            if (p->size < min || min == 0){
+                min = p->size;
+            }
+            M += p->size*sizeof(mchunk_t);
+            NumItems++;
+            if (a == SHORT_ARENA){
+                ShortItems++;
+                ShortM += p->size*sizeof(mchunk_t);
+            }
+            p = p->next;
         }
-        if (Rover != &DummyChunk && Rover->size < min){
-            min = Rover->size;
-        } 
-        M += Rover->size*sizeof(mchunk_t);
-        NumItems++;
-        Rover = Rover->next;
     }
-    while (Rover != starter);{
-        average = M/NumItems; //updates average everytime it loops
+    if (NumItems > 0){
+        average = M/NumItems;
     }
 
     printf("Number of items: %d\n", NumItems); //print statements
-    printf("Min size: %ld\n", (min * sizeof(mchunk_t)));
-    printf("Max size: %ld\n", (max * sizeof(mchunk_t)));
-    printf("Average size: %d\n", average);
-    printf("Total memory: %d\n", M);
+    printf("Min size: %zu\n", (min * sizeof(mchunk_t)));
+    printf("Max size: %zu\n", (max * sizeof(mchunk_t)));
+    printf("Average size: %zu\n", average);
+    printf("Total memory: %zu\n", M);
     printf("Number of calls to sbrk(): %d\n", NumSbrkCalls);
-    printf("Total number of pages requested: %d\n", NumPages);
+    if (NumHugeCalls > 0)   // these grew the heap from mmap reservations
+        printf("Number of calls to morecore() from huge page reservations: %d\n", NumHugeCalls);
+    printf("Total number of pages requested: %zu\n", NumPages);
+    printf("Heap size: %zu bytes\n", NumPages * PAGESIZE);
+    printf("Peak heap size: %zu bytes\n", PeakPages * PAGESIZE);
+    if (NumHugeReserves > 0)
+        printf("Huge page reservations: %d\n", NumHugeReserves);
+    if (ShortItems > 0)
+        printf("Short-lived arena: %d items, %zu bytes\n", ShortItems, ShortM);
+    if (NumTrimmedPages > 0)
+        printf("Pages returned to the OS by Mem_compact: %zu\n", NumTrimmedPages);
     if (M == NumPages * PAGESIZE){
         printf("all memory is in the heap -- no leaks are possible\n");   
     }
@@ -333,6 +749,220 @@ void Mem_stats(void)
     // that M == NumPages * PAGESiZE then print
 }
 
+/* returns a handle to space for an object of size nbytes, or
+ * MEM_NULL_HANDLE if the request cannot be satisfied.
+ *
+ * The block itself comes from Mem_alloc; the handle slot records where the
+ * block currently lives so Mem_compact can move it.
+ */
+mhandle_t Mem_halloc(const size_t nbytes)
+{
+    mhandle_t h;
+    void *q = Mem_alloc(nbytes);
+    if (q == NULL)
+        return MEM_NULL_HANDLE;
+
+    if (FreeHandle == MEM_NULL_HANDLE) { //no unused slots so grow the table
+        int old_slots = NumHandleSlots;
+        NumHandleSlots = old_slots == 0 ? 64 : 2*old_slots;
+        Handles = (mhandle_slot_t *) realloc(Handles,
+                NumHandleSlots*sizeof(mhandle_slot_t));
+        assert(Handles != NULL);
+        for (h = NumHandleSlots - 1; h >= old_slots && h > MEM_NULL_HANDLE; h--) {
+            Handles[h].block = NULL;
+            Handles[h].lock_count = 0;
+            Handles[h].next_free = FreeHandle;
+            FreeHandle = h;
+        }
+    }
+    h = FreeHandle;
+    FreeHandle = Handles[h].next_free;
+    Handles[h].block = ((mchunk_t *) q) - 1;
+    Handles[h].lock_count = 0;
+    return h;
+}
+
+/* pins the block named by handle and returns its address
+ */
+void *Mem_lock(mhandle_t handle)
+{
+    assert(MEM_NULL_HANDLE < handle && handle < NumHandleSlots);
+    assert(Handles[handle].block != NULL);
+    Handles[handle].lock_count++;
+    return Handles[handle].block + 1;
+}
+
+/* releases one lock on the block named by handle
+ */
+void Mem_unlock(mhandle_t handle)
+{
+    assert(MEM_NULL_HANDLE < handle && handle < NumHandleSlots);
+    assert(Handles[handle].block != NULL);
+    assert(Handles[handle].lock_count > 0);
+    Handles[handle].lock_count--;
+}
+
+/* frees the block named by handle and puts the slot back on the unused
+ * chain
+ */
+void Mem_hfree(mhandle_t handle)
+{
+    assert(MEM_NULL_HANDLE < handle && handle < NumHandleSlots);
+    assert(Handles[handle].block != NULL);
+    assert(Handles[handle].lock_count == 0);
+    Mem_free(Handles[handle].block + 1);
+    Handles[handle].block = NULL;
+    Handles[handle].next_free = FreeHandle;
+    FreeHandle = handle;
+}
+
+/* qsort comparison to order handles by the address of their blocks */
+static int mem_handle_cmp(const void *a, const void *b)
+{
+    mchunk_t *pa = Handles[*(const int *) a].block;
+    mchunk_t *pb = Handles[*(const int *) b].block;
+    return (pa > pb) - (pa < pb);
+}
+
+/* turns the units from gap up to end into a free block at the end of the
+ * free list being rebuilt by Mem_compact.  A gap of one unit is given to
+ * the block just in front of it when that block was moved, since a size
+ * one block is useless.  Returns the new last block in the list.
+ */
+static mchunk_t *mem_close_gap(mchunk_t *tail, mchunk_t *gap, mchunk_t *end,
+        mchunk_t *last_moved)
+{
+    if (gap == end)
+        return tail;
+    if (end - gap == 1 && last_moved != NULL && last_moved + last_moved->size == gap) {
+        last_moved->size++;
+        return tail;
+    }
+    gap->size = end - gap;
+    gap->prev = tail;
+    tail->next = gap;
+    return gap;
+}
+
+/* Every free block is dropped from the free list, each region is walked in
+ * address order, and unlocked handle blocks are copied down over the free
+ * space in front of them.  Blocks from Mem_alloc and locked handle blocks
+ * stay where they are, so the free space in front of each one becomes a
+ * single free block.  The free list is rebuilt in address order, which is
+ * valid with or without coalescing.
+ */
+void Mem_compact(void)
+{
+    assert(Rover != NULL && Rover->next != NULL && Rover->prev != NULL);
+    int *movable = NULL;     // unlocked handles sorted by block address
+    int num_movable = 0;
+    int next_movable = 0;
+    int h, r;
+    mchunk_t *p, *next_p, *dst, *last_moved;
+    mchunk_t *tail[MEM_ARENAS];   // last block of each rebuilt free list
+    int a;
+
+    for (a = 0; a < MEM_ARENAS; a++)
+        tail[a] = ArenaDummy[a];
+
+    if (NumHandleSlots > 0) {
+        movable = (int *) malloc(NumHandleSlots*sizeof(int));
+        assert(movable != NULL);
+    }
+    for (h = MEM_NULL_HANDLE + 1; h < NumHandleSlots; h++)
+        if (Handles[h].block != NULL && Handles[h].lock_count == 0)
+            movable[num_movable++] = h;
+    qsort(movable, num_movable, sizeof(int), mem_handle_cmp);
+
+    for (r = 0; r < NumRegions; r++) {
+        a = Regions[r].arena;
+        dst = Regions[r].start;   // where the next moved block goes
+        last_moved = NULL;
+        for (p = Regions[r].start; p < Regions[r].end; p = next_p) {
+            next_p = p + p->size;   // find before p is overwritten
+            if (p->next != NULL)    // free block, its space is reclaimed
+                continue;
+            if (next_movable < num_movable
+                    && Handles[movable[next_movable]].block == p) {
+                h = movable[next_movable++];
+                if (dst != p) {
+                    memmove(dst, p, p->size*sizeof(mchunk_t));
+                    Handles[h].block = dst;
+                }
+                last_moved = dst;
+                dst += dst->size;
+            } else {   // pinned block
+                tail[a] = mem_close_gap(tail[a], dst, p, last_moved);
+                dst = next_p;
+                last_moved = NULL;
+            }
+        }
+        tail[a] = mem_close_gap(tail[a], dst, Regions[r].end, last_moved);
+    }
+    assert(next_movable == num_movable);
+    for (a = 0; a < MEM_ARENAS; a++) {
+        tail[a]->next = ArenaDummy[a];
+        ArenaDummy[a]->prev = tail[a];
+        ArenaRover[a] = ArenaDummy[a];
+    }
+    Rover = ArenaDummy[Arena];
+    free(movable);
+
+    mem_trim();
+}
+
+/* gives whole pages at the top of the heap back to the operating system.
+ * This is only possible if the last free block reaches the current program
+ * break, that is, nothing else has called sbrk since.  With HugePages the
+ * top of the current reservation plays the part of the break; the pages
+ * stay reserved for the next morecore but their memory is released.
+ */
+void mem_trim(void)
+{
+    mchunk_t *dummy, *top;
+    mregion_t *last;
+    size_t units_per_page = PAGESIZE/sizeof(mchunk_t);
+    size_t pages, keep;
+
+    if (NumRegions == 0)
+        return;
+    last = &Regions[NumRegions-1];
+    dummy = ArenaDummy[last->arena];
+    top = dummy->prev;    // the free list is in address order
+    if (top == dummy || top + top->size != last->end)
+        return;
+    if ((char *) last->end != HugeBrk && (void *) last->end != sbrk(0))
+        return;
+
+    pages = top->size/units_per_page;
+    keep = top->size - pages*units_per_page;
+    if (keep == 1 && pages > 0) {   // do not leave a size one block behind
+        pages--;
+        keep += units_per_page;
+    }
+    if (pages == 0 || pages*PAGESIZE > INTPTR_MAX)
+        return;
+    if ((char *) last->end == HugeBrk) {
+        HugeBrk -= pages*PAGESIZE;
+        madvise(HugeBrk, pages*PAGESIZE, MADV_DONTNEED);
+    } else if (sbrk(-(intptr_t) (pages*PAGESIZE)) == (void *) -1)
+        return;
+    last->end -= pages*units_per_page;
+    NumPages -= pages;
+    NumTrimmedPages += pages;
+    if (keep > 0) {
+        top->size = keep;
+    } else {
+        top->prev->next = dummy;
+        dummy->prev = top->prev;
+        if (last->end == last->start)
+            NumRegions--;
+    }
+    ArenaRover[last->arena] = dummy;
+    if (last->arena == Arena)
+        Rover = dummy;
+}
+
 /* print table of memory in free list 
  *
  * The print should include the dummy item in the list 
@@ -352,12 +982,20 @@ void Mem_print(void)
         if (p->size == 0) message = 1;
         else if (p->size == 1) message = 2;
         else message = 0;
-        printf("p=%p, size=%d (units), end=%p, next=%p, prev=%p %s\n", 
+        printf("p=%p, size=%zu (units), end=%p, next=%p, prev=%p %s\n", 
                 p, p->size, p + p->size, p->next, p->prev,
                 comments[message]);
         p = p->next;
     } while (p != start);
     mem_validate();
+
+    if (Arena != SHORT_ARENA && ShortDummyChunk.next != &ShortDummyChunk) {
+        int active = Arena;
+        printf("short-lived arena:\n");
+        mem_set_arena(SHORT_ARENA);
+        Mem_print();
+        mem_set_arena(active);
+    }
 }
 
 /* This is an experimental function to attempt to validate the free
@@ -370,15 +1008,14 @@ void mem_validate(void)
 {
     // note position of Rover is not changed by this function
     assert(Rover != NULL && Rover->next != NULL && Rover->prev != NULL);
-    assert(Rover->size >= 0);
     int wrapped = FALSE;
     int found_dummy = FALSE;
     int found_rover = FALSE;
     int size_warning = FALSE;
     mchunk_t *p, *largest, *smallest;
 
-    // for validate begin at DummyChunk
-    p = &DummyChunk;
+    // for validate begin at the dummy of the active arena
+    p = ArenaDummy[Arena];
     do {
         assert(p->next->prev == p);
         if (p->size == 0) {
@@ -395,7 +1032,7 @@ void mem_validate(void)
             found_rover = TRUE;
         }
         p = p->next;
-    } while (p != &DummyChunk);
+    } while (p != ArenaDummy[Arena]);
     assert(found_dummy == TRUE);
     assert(found_rover == TRUE);
     if (size_warning == TRUE) {
@@ -420,7 +1057,7 @@ void mem_validate(void)
                 assert(p + p->size < p->next);
             }
             p = p->next;
-        } while (p != &DummyChunk);
+        } while (p != ArenaDummy[Arena]);
         assert(wrapped == TRUE);
     }
 }
@@ -3,6 +3,8 @@
  * Fall 2022
  */
 
+#include <stddef.h>        // size_t
+
 #define PAGESIZE 4096      // number of bytes in one page
 #define FIRST_FIT 0xFF 
 #define BEST_FIT  0xBF
@@ -15,22 +17,71 @@ int SearchPolicy;
 // TRUE if memory returned to free list is coalesced 
 int Coalescing;
 
+/* TRUE if new heap pages come from 2 MiB aligned mmap reservations advised
+ * with MADV_HUGEPAGE instead of sbrk, so the kernel can back large heaps
+ * with transparent huge pages.  It may be changed between calls; pages
+ * already in the heap stay where they are.
+ */
+int HugePages;
+
 /* deallocates the space pointed to by return_ptr; it does nothing if
  * return_ptr is NULL.  
  */
 void Mem_free(void *return_ptr);
 
 /* returns a pointer to space for an object of size nbytes, or NULL if the
- * request cannot be satisfied.  The space is uninitialized.
+ * request cannot be satisfied.  The space is uninitialized.  Requests too
+ * large to describe in units or pages without overflow return NULL.
+ */
+void *Mem_alloc(const size_t nbytes);
+
+/* allocates count blocks of nbytes each and stores their addresses in
+ * out[0] to out[count-1].  Returns the number of blocks allocated, which is
+ * less than count only if the request cannot be satisfied.  Each block is
+ * returned with Mem_free or Mem_free_batch.
+ */
+int Mem_alloc_batch(const size_t nbytes, int count, void **out);
+
+/* deallocates the n blocks in ptrs, skipping NULL entries.  With
+ * coalescing on, ptrs is sorted by address as a side effect; otherwise its
+ * order is left alone.
+ */
+void Mem_free_batch(void **ptrs, int n);
+
+/* ----- allocation-site lifetime segregation -----
+ *
+ * Mem_alloc_tagged works like Mem_alloc but names the call site that made
+ * the request.  For each site the allocator learns the average lifetime of
+ * its blocks, measured in allocations between Mem_alloc_tagged and
+ * Mem_free.  Once a site has been seen to free its blocks quickly, its
+ * requests are served from a separate short-lived arena with its own free
+ * list and its own pages, so that churning buffers do not leave holes
+ * between long-lived blocks.  Sites that have not freed anything yet are
+ * treated as long lived.  Blocks from either arena are returned with
+ * Mem_free.
+ *
+ * site_id is any nonzero value that is unique to the call site.
+ */
+void *Mem_alloc_tagged(const size_t nbytes, unsigned long site_id);
+
+/* tags an allocation with the return address of the function that uses
+ * the macro, that is the place in its caller that called it.  Each call
+ * of that function from a different place is a different site, so put the
+ * macro in a small function for each kind of allocation and call it from
+ * one place.  Mark the function noinline: inlined, the return address is
+ * that of the function it was inlined into.
  */
-void *Mem_alloc(const int nbytes);
+#define MEM_ALLOC_SITE(nbytes) \
+    Mem_alloc_tagged((nbytes), (unsigned long) __builtin_return_address(0))
 
 /* prints stats about the current free list
  *
  * number of items in the linked list
  * min, max, and average size of each item (bytes)
  * total memory in list (bytes)
- * number of calls to sbrk and number of pages requested
+ * number of calls to sbrk, number of calls to morecore that took pages
+ * from huge page reservations, and number of pages requested
+ * largest heap size seen so far
  */
 void Mem_stats(void);
 
@@ -38,11 +89,50 @@ void Mem_stats(void);
  * A unit is the size of one mchunk_t structure
  * example format
  *     mchunk_t *p;
- *     printf("p=%p, size=%d (units), end=%p, next=%p, prev=%p\n", 
+ *     printf("p=%p, size=%zu (units), end=%p, next=%p, prev=%p\n", 
  *              p, p->size, p + p->size, p->next, p->prev);
  */
 void Mem_print(void);
 
+/* ----- relocatable (handle-based) allocations -----
+ *
+ * A handle names a block that Mem_compact is allowed to move.  The block
+ * address is only valid between Mem_lock and the matching Mem_unlock;
+ * locked blocks are pinned and are never moved.  Blocks from Mem_alloc are
+ * always pinned.  A handle value of MEM_NULL_HANDLE is never valid.
+ */
+#define MEM_NULL_HANDLE 0
+typedef int mhandle_t;
+
+/* returns a handle to space for an object of size nbytes, or
+ * MEM_NULL_HANDLE if the request cannot be satisfied.  The block starts
+ * unlocked.
+ */
+mhandle_t Mem_halloc(const size_t nbytes);
+
+/* pins the block and returns its current address.  Locks nest, so each
+ * call must be matched by a call to Mem_unlock.
+ */
+void *Mem_lock(mhandle_t handle);
+
+/* releases one lock.  Once the lock count drops to zero, pointers returned
+ * by Mem_lock are no longer valid.
+ */
+void Mem_unlock(mhandle_t handle);
+
+/* returns the block to the free list and releases the handle.  The block
+ * must not be locked.
+ */
+void Mem_hfree(mhandle_t handle);
+
+/* slides every unlocked handle block down towards the start of its heap
+ * region so that the free space between pinned blocks is merged, rebuilds
+ * the free list in address order, and returns whole pages at the top of
+ * the heap to the operating system when nothing else owns the memory
+ * above them.
+ */
+void Mem_compact(void);
+
 /* The mchunk_t definition.  
  *
  * We don't really need the definition of mchunk_t in mem.h.  However,
@@ -53,8 +143,11 @@ void Mem_print(void);
 typedef struct memory_chunk_tag {
     struct memory_chunk_tag *prev;   // prev block in free list
     struct memory_chunk_tag *next;   // next block in free list
-    int size;                        // one unit equals sizeof(mchunk_t)
-    char padding[12];                // unused
+    size_t size;                     // one unit equals sizeof(mchunk_t)
+    unsigned int birth;              // allocation count when handed out
+    unsigned short site;             // Mem_alloc_tagged site, 0 if untagged
+    unsigned char arena;             // free list the block belongs to
+    char padding[1];                 // unused
 } mchunk_t;
 
 /* vi:set ts=8 sts=4 sw=4 et: */
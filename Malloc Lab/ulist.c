@@ -0,0 +1,707 @@
+/* ulist.c
+ * Fall 2022
+ *
+ * Purpose: Unrolled version of the two-way linked list in list.c.  It
+ * implements the same public functions from list.h, and is used in place
+ * of list.c when the program is compiled with -DLIST_UNROLLED.
+ *
+ * The list is a two-way linked list of chunks.  A chunk holds up to
+ * LIST_CHUNK_SLOTS data pointers in slot[0] to slot[count-1], and an
+ * iterator is a pointer to one of those slots.  A chunk that fills up is
+ * split in half, and a chunk that runs low is merged with a neighbour, so
+ * chunks stay at least partly full and a walk of the list reads mostly
+ * consecutive memory.
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+#include <pthread.h>
+
+#include "datatypes.h"   /* defines data_t */
+#include "list.h"        /* defines public functions for list ADT */
+
+#ifndef LIST_UNROLLED
+#error "ulist.c must be compiled with -DLIST_UNROLLED"
+#endif
+
+/* definitions for private constants used in ulist.c only */
+#define SORTED_LIST   -123465
+#define UNSORTED_LIST -632154
+
+/* a chunk with fewer elements than this is merged with a neighbour if the
+ * two fit in MERGE_LIMIT slots, which leaves room for inserts before the
+ * merged chunk has to be split again
+ */
+#define MERGE_BELOW (LIST_CHUNK_SLOTS/4)
+#define MERGE_LIMIT (3*LIST_CHUNK_SLOTS/4)
+
+/* prototypes for private functions used in ulist.c only */
+void list_debug_validate(list_t *L);
+static void list_check(list_t *L);
+
+/* runs list_debug_validate as often as LIST_VALIDATE asks for */
+static void list_check(list_t *L)
+{
+#if LIST_VALIDATE == LIST_VALIDATE_FULL
+    list_debug_validate(L);
+#elif LIST_VALIDATE == LIST_VALIDATE_SAMPLED
+    // not atomic; a count lost to a race only moves the next sample.
+    // Waiting for as many calls as L has elements keeps the walk O(1)
+    // amortized per call.
+    static unsigned long calls = 0;
+
+    if (++calls >= LIST_VALIDATE_EVERY
+            && calls >= (unsigned long) L->current_list_size) {
+        calls = 0;
+        list_debug_validate(L);
+    }
+#else
+    (void) L;
+#endif
+}
+
+/* ----- private chunk functions ----- */
+
+/* returns the chunk that holds the slot idx_ptr points to */
+static list_chunk_t *ulist_chunk_of(list_node_t *idx_ptr)
+{
+    return (list_chunk_t *) ((uintptr_t) idx_ptr & ~(uintptr_t) (LIST_CHUNK_BYTES - 1));
+}
+
+/* allocates an empty chunk and links it into the list after prev, or at
+ * the head if prev is NULL
+ */
+static list_chunk_t *ulist_chunk_new(list_t *L, list_chunk_t *prev)
+{
+    list_chunk_t *c;
+
+    assert(sizeof(list_chunk_t) <= LIST_CHUNK_BYTES);
+    c = (list_chunk_t *) aligned_alloc(LIST_CHUNK_BYTES, LIST_CHUNK_BYTES);
+    assert(c != NULL);
+    c->count = 0;
+    c->prev = prev;
+    c->next = prev == NULL ? L->head : prev->next;
+    if (c->prev != NULL)
+        c->prev->next = c;
+    else
+        L->head = c;
+    if (c->next != NULL)
+        c->next->prev = c;
+    else
+        L->tail = c;
+    return c;
+}
+
+/* unlinks c from the list and frees it.  c must be empty. */
+static void ulist_chunk_free(list_t *L, list_chunk_t *c)
+{
+    assert(c->count == 0);
+    if (c->prev != NULL)
+        c->prev->next = c->next;
+    else
+        L->head = c->next;
+    if (c->next != NULL)
+        c->next->prev = c->prev;
+    else
+        L->tail = c->prev;
+    c->prev = NULL;
+    c->next = NULL;
+    free(c);
+}
+
+/* moves every element of the chunk after c to the end of c and frees the
+ * chunk that is left empty
+ */
+static void ulist_chunk_merge(list_t *L, list_chunk_t *c)
+{
+    list_chunk_t *n = c->next;
+
+    assert(n != NULL && c->count + n->count <= (int) LIST_CHUNK_SLOTS);
+    memcpy(c->slot + c->count, n->slot, n->count*sizeof(data_t *));
+    c->count += n->count;
+    n->count = 0;
+    ulist_chunk_free(L, n);
+}
+
+/* stores elem_ptr at slot i of chunk c, where i is between 0 and c->count,
+ * and returns the iterator for it.  A full chunk is first split in half.
+ */
+static list_node_t *ulist_insert_slot(list_t *L, list_chunk_t *c, int i, data_t *elem_ptr)
+{
+    list_chunk_t *n;
+    int half;
+
+    assert(0 <= i && i <= c->count);
+    if (c->count == (int) LIST_CHUNK_SLOTS) {
+        n = ulist_chunk_new(L, c);
+        half = c->count/2;
+        memcpy(n->slot, c->slot + half, (c->count - half)*sizeof(data_t *));
+        n->count = c->count - half;
+        c->count = half;
+        if (i > half) {
+            c = n;
+            i -= half;
+        }
+    }
+    memmove(c->slot + i + 1, c->slot + i, (c->count - i)*sizeof(data_t *));
+    c->slot[i] = elem_ptr;
+    c->count++;
+    L->current_list_size++;
+    return c->slot + i;
+}
+
+/* adds elem_ptr after the last element.  Appends fill the tail chunk
+ * completely before a new chunk is started.
+ */
+static list_node_t *ulist_append(list_t *L, data_t *elem_ptr)
+{
+    list_chunk_t *c = L->tail;
+
+    if (c == NULL || c->count == (int) LIST_CHUNK_SLOTS)
+        c = ulist_chunk_new(L, L->tail);
+    return ulist_insert_slot(L, c, c->count, elem_ptr);
+}
+
+/* ----- below are the functions  ----- */
+
+/* Allocates a new, empty list
+ *
+ * If the comparison function is NULL, then the list is unsorted.
+ *
+ * Otherwise, the list is initially assumed to be sorted.  Note that if
+ * list_insert is used the list is changed to unsorted.
+ */
+list_t * list_construct(int (*compare_function)(const data_t *, const data_t *))
+{
+    list_t *L;
+
+    L = (list_t *) malloc(sizeof(list_t));
+    assert(L != NULL);
+    L->head = NULL;
+    L->tail = NULL;
+    L->current_list_size = 0;
+    L->comp_proc = compare_function;
+    if (compare_function == NULL)
+        L->list_sorted_state = UNSORTED_LIST;
+    else
+        L->list_sorted_state = SORTED_LIST;
+
+    list_check(L);
+    return L;
+}
+
+/* An unrolled list has no separate position index.  list_iter_at skips
+ * whole chunks by their counts, which is already LIST_CHUNK_SLOTS times
+ * faster than walking nodes, so this is the same as list_construct.
+ */
+list_t * list_construct_indexed(int (*compare_function)(const data_t *, const data_t *))
+{
+    return list_construct(compare_function);
+}
+
+/* Allocates a new, unsorted list that holds the n pointers in elems, in
+ * order.  Chunks are freed one at a time when they empty, so they cannot
+ * share one allocation; instead every chunk is filled completely, which
+ * takes one allocation per LIST_CHUNK_SLOTS elements.
+ */
+list_t * list_from_array(data_t **elems, int n)
+{
+    list_t *L = list_construct(NULL);
+    list_chunk_t *c;
+    int i, k;
+
+    assert(n >= 0 && (n == 0 || elems != NULL));
+    for (i = 0; i < n; i += k) {
+        c = ulist_chunk_new(L, L->tail);
+        k = n - i < (int) LIST_CHUNK_SLOTS ? n - i : (int) LIST_CHUNK_SLOTS;
+        memcpy(c->slot, elems + i, k*sizeof(data_t *));
+        c->count = k;
+    }
+    L->current_list_size = n;
+    list_check(L);
+    return L;
+}
+
+/* Free all elements in the list, the chunks, and the header block. */
+void list_destruct(list_t *list_ptr)
+{
+    list_chunk_t *c;
+    int i;
+
+    assert(list_ptr != NULL);
+    list_check(list_ptr);
+    while ((c = list_ptr->tail) != NULL) {
+        for (i = 0; i < c->count; i++) {
+            free(c->slot[i]);
+            c->slot[i] = NULL;
+        }
+        c->count = 0;
+        ulist_chunk_free(list_ptr, c);
+    }
+    free(list_ptr);
+}
+
+/* Return an Iterator that points to the first element in the list.  If the
+ * list is empty the value that is returned in NULL.
+ */
+list_node_t * list_iter_front(list_t *list_ptr)
+{
+    assert(list_ptr != NULL);
+    list_check(list_ptr);
+    if (list_ptr->head == NULL)
+        return NULL;
+    return list_ptr->head->slot;
+}
+
+/* Return an Iterator that points to the last element. If the list is empty
+ * then the pointer that is returned is NULL.
+ */
+list_node_t * list_iter_back(list_t *list_ptr)
+{
+    assert(list_ptr != NULL);
+    list_check(list_ptr);
+    if (list_ptr->tail == NULL)
+        return NULL;
+    return list_ptr->tail->slot + list_ptr->tail->count - 1;
+}
+
+/* Advance the Iterator to the next item in the list.  Returns NULL if the
+ * iterator points to the last item in the list.
+ */
+list_node_t * list_iter_next(list_node_t * idx_ptr)
+{
+    list_chunk_t *c;
+
+    assert(idx_ptr != NULL);
+    c = ulist_chunk_of(idx_ptr);
+    if (idx_ptr + 1 < c->slot + c->count)
+        return idx_ptr + 1;
+    if (c->next == NULL)
+        return NULL;
+    return c->next->slot;
+}
+
+/* Return an Iterator that points to the element at position pos, or NULL
+ * if pos is not between 0 and list_size - 1.  Whole chunks are skipped
+ * from whichever end of the list is closer.
+ */
+list_node_t * list_iter_at(list_t *list_ptr, int pos)
+{
+    list_chunk_t *c;
+
+    assert(list_ptr != NULL);
+    if (pos < 0 || pos >= list_ptr->current_list_size)
+        return NULL;
+    if (pos < list_ptr->current_list_size/2) {
+        for (c = list_ptr->head; pos >= c->count; c = c->next)
+            pos -= c->count;
+    } else {
+        pos = list_ptr->current_list_size - 1 - pos;   // position from the back
+        for (c = list_ptr->tail; pos >= c->count; c = c->prev)
+            pos -= c->count;
+        pos = c->count - 1 - pos;
+    }
+    return c->slot + pos;
+}
+
+/* Obtains a pointer to the element at the iterator position, or NULL if
+ * the list is empty or idx_ptr is NULL.
+ */
+data_t * list_access(list_t *list_ptr, list_node_t * idx_ptr)
+{
+    assert(list_ptr != NULL);
+    if (idx_ptr == NULL || list_ptr->head == NULL)
+        return NULL;
+    return *idx_ptr;
+}
+
+/* Returns an Iterator to the first element for which compare_function
+ * returns 0, or NULL if there is no match.
+ */
+list_node_t * list_elem_find(list_t *list_ptr, data_t *elem_ptr,
+        int (*compare_function)(const data_t *, const data_t *))
+{
+    list_chunk_t *c;
+    int i;
+    int ordered = list_ptr->list_sorted_state == SORTED_LIST
+        && compare_function == list_ptr->comp_proc;
+
+    for (c = list_ptr->head; c != NULL; c = c->next) {
+        // on a sorted list skip chunks whose last element is before elem_ptr.
+        // The first chunk that is not skipped holds the first element that
+        // is not before elem_ptr, so the search ends there.
+        if (ordered && compare_function(c->slot[c->count-1], elem_ptr) == 1)
+            continue;
+        for (i = 0; i < c->count; i++)
+            if (compare_function(elem_ptr, c->slot[i]) == 0)
+                return c->slot + i;
+        if (ordered)
+            break;
+    }
+
+    list_check(list_ptr);
+    return NULL;
+}
+
+/* Inserts the data element into the list in front of the iterator
+ * position, or after the last element if idx_ptr is NULL.  The list is
+ * marked as unsorted.
+ */
+void list_insert(list_t *list_ptr, data_t *elem_ptr, list_node_t * idx_ptr)
+{
+    list_chunk_t *c;
+
+    assert(list_ptr != NULL);
+    list_ptr->list_sorted_state = UNSORTED_LIST;
+    if (idx_ptr == NULL) {
+        ulist_append(list_ptr, elem_ptr);
+    } else {
+        c = ulist_chunk_of(idx_ptr);
+        ulist_insert_slot(list_ptr, c, idx_ptr - c->slot, elem_ptr);
+    }
+    list_check(list_ptr);
+}
+
+/* Inserts the element into the sorted list after all the elements that
+ * come before it or are equal in rank, as defined by comp_proc.  It is an
+ * error to call this function on an unsorted list.
+ */
+void list_insert_sorted(list_t *list_ptr, data_t *elem_ptr)
+{
+    list_chunk_t *c;
+    int i;
+
+    assert(list_ptr != NULL);
+    assert(list_ptr->list_sorted_state == SORTED_LIST);
+
+    // search from the back for the last element that is not after elem_ptr,
+    // skipping chunks whose first element is already after it
+    for (c = list_ptr->tail; c != NULL; c = c->prev) {
+        if (list_ptr->comp_proc(c->slot[0], elem_ptr) == -1)
+            continue;
+        for (i = c->count - 1; i >= 0; i--)
+            if (list_ptr->comp_proc(c->slot[i], elem_ptr) != -1)
+                break;
+        if (i >= 0)
+            break;
+    }
+    if (c != NULL)
+        ulist_insert_slot(list_ptr, c, i + 1, elem_ptr);
+    else if (list_ptr->head != NULL)
+        ulist_insert_slot(list_ptr, list_ptr->head, 0, elem_ptr);
+    else
+        ulist_append(list_ptr, elem_ptr);
+    list_check(list_ptr);
+}
+
+/* Inserts the data element so that it ends up at position pos.  A pos
+ * equal to list_size makes the element the new tail.  Like list_insert_at
+ * in list.c it does not call list_debug_validate.
+ */
+void list_insert_at(list_t *list_ptr, data_t *elem_ptr, int pos)
+{
+    list_chunk_t *c;
+    list_node_t *idx_ptr;
+
+    assert(list_ptr != NULL);
+    assert(elem_ptr != NULL);
+    assert(0 <= pos && pos <= list_ptr->current_list_size);
+    list_ptr->list_sorted_state = UNSORTED_LIST;
+    idx_ptr = list_iter_at(list_ptr, pos);
+    if (idx_ptr == NULL) {
+        ulist_append(list_ptr, elem_ptr);
+    } else {
+        c = ulist_chunk_of(idx_ptr);
+        ulist_insert_slot(list_ptr, c, idx_ptr - c->slot, elem_ptr);
+    }
+}
+
+/* Removes the element at the iterator position and returns it.  If idx_ptr
+ * is NULL the element at the head is removed.  Returns NULL if the list is
+ * empty.
+ */
+data_t * list_remove(list_t *list_ptr, list_node_t * idx_ptr)
+{
+    list_chunk_t *c;
+    data_t *elem_ptr;
+    int i;
+
+    assert(list_ptr != NULL);
+    if (list_ptr->current_list_size == 0) {
+        assert(idx_ptr == NULL);
+        return NULL;
+    }
+    if (idx_ptr == NULL)
+        idx_ptr = list_ptr->head->slot;
+    c = ulist_chunk_of(idx_ptr);
+    i = idx_ptr - c->slot;
+    assert(0 <= i && i < c->count);
+    elem_ptr = c->slot[i];
+    memmove(c->slot + i, c->slot + i + 1, (c->count - i - 1)*sizeof(data_t *));
+    c->count--;
+    list_ptr->current_list_size--;
+
+    if (c->count == 0)
+        ulist_chunk_free(list_ptr, c);
+    else if (c->count < (int) MERGE_BELOW) {
+        if (c->next != NULL && c->count + c->next->count <= (int) MERGE_LIMIT)
+            ulist_chunk_merge(list_ptr, c);
+        else if (c->prev != NULL && c->prev->count + c->count <= (int) MERGE_LIMIT)
+            ulist_chunk_merge(list_ptr, c->prev);
+    }
+    return elem_ptr;
+}
+
+/* Removes the element at position pos and returns it, or returns NULL if
+ * pos is not between 0 and list_size - 1.
+ */
+data_t * list_remove_at(list_t *list_ptr, int pos)
+{
+    list_node_t *idx_ptr;
+
+    assert(list_ptr != NULL);
+    idx_ptr = list_iter_at(list_ptr, pos);
+    if (idx_ptr == NULL)
+        return NULL;
+    return list_remove(list_ptr, idx_ptr);
+}
+
+/* Moves every element of src into dst in front of the iterator position,
+ * or after the last element if idx_ptr is NULL, and leaves src empty.
+ * idx_ptr must point into dst.  The chunks of src are relinked, not
+ * copied; if idx_ptr is in the middle of a chunk that chunk is split
+ * first.  dst is marked as unsorted.  Like list_insert_at it does not
+ * call list_debug_validate.
+ */
+void list_splice(list_t *dst, list_node_t *idx_ptr, list_t *src)
+{
+    list_chunk_t *c, *n, *before, *after;
+    int i;
+
+    assert(dst != NULL && src != NULL && dst != src);
+    if (src->current_list_size == 0)
+        return;
+    if (idx_ptr == NULL) {
+        before = dst->tail;
+        after = NULL;
+    } else {
+        c = ulist_chunk_of(idx_ptr);
+        i = idx_ptr - c->slot;
+        assert(0 <= i && i < c->count);
+        if (i > 0) {   // move slots i.. of c into a new chunk after it
+            n = ulist_chunk_new(dst, c);
+            memcpy(n->slot, c->slot + i, (c->count - i)*sizeof(data_t *));
+            n->count = c->count - i;
+            c->count = i;
+            c = n;
+        }
+        before = c->prev;
+        after = c;
+    }
+
+    src->head->prev = before;
+    src->tail->next = after;
+    if (before != NULL)
+        before->next = src->head;
+    else
+        dst->head = src->head;
+    if (after != NULL)
+        after->prev = src->tail;
+    else
+        dst->tail = src->tail;
+    dst->current_list_size += src->current_list_size;
+    dst->list_sorted_state = UNSORTED_LIST;
+
+    src->head = NULL;
+    src->tail = NULL;
+    src->current_list_size = 0;
+}
+
+/* Moves every element of src to the end of dst and leaves src empty */
+void list_concat(list_t *dst, list_t *src)
+{
+    list_splice(dst, NULL, src);
+}
+
+/* ----- merge sort ----- */
+
+/* The elements are copied out of the chunks into an array, sorted there,
+ * and copied back, so the chunks keep their counts.
+ */
+
+/* merges the sorted ranges a[lo..mid-1] and a[mid..hi-1] through tmp,
+ * taking from the left range when elements are equal
+ */
+static void ulist_merge(data_t **a, data_t **tmp, int lo, int mid, int hi,
+        int (*fcomp)(const data_t *, const data_t *))
+{
+    int i = lo, j = mid, k = lo;
+
+    if (mid == lo || mid == hi || fcomp(a[mid-1], a[mid]) != -1)
+        return;   // already in order
+    while (i < mid && j < hi)
+        tmp[k++] = fcomp(a[i], a[j]) != -1 ? a[i++] : a[j++];
+    while (i < mid)
+        tmp[k++] = a[i++];
+    memcpy(a + lo, tmp + lo, (j - lo)*sizeof(data_t *));
+}
+
+/* natural bottom-up merge sort of a[lo..hi-1].  The first pass finds the
+ * runs that are already in order, reversing runs in strictly reverse
+ * order, and later passes merge neighbouring runs until one is left.
+ * runs must have room for hi - lo + 1 entries.
+ */
+static void ulist_merge_sort(data_t **a, data_t **tmp, int *runs, int lo, int hi,
+        int (*fcomp)(const data_t *, const data_t *))
+{
+    int nruns = 0, i, j, k;
+    data_t *t;
+
+    for (i = lo; i < hi; i = j) {
+        runs[nruns++] = i;
+        j = i + 1;
+        if (j < hi && fcomp(a[i], a[j]) == -1) {
+            while (j < hi && fcomp(a[j-1], a[j]) == -1)
+                j++;
+            for (k = 0; k < (j - i)/2; k++) {
+                t = a[i+k];
+                a[i+k] = a[j-1-k];
+                a[j-1-k] = t;
+            }
+        } else {
+            while (j < hi && fcomp(a[j-1], a[j]) != -1)
+                j++;
+        }
+    }
+    runs[nruns] = hi;
+    while (nruns > 1) {
+        for (i = 0, k = 0; i < nruns; i += 2, k++) {
+            if (i + 1 < nruns)
+                ulist_merge(a, tmp, runs[i], runs[i+1], runs[i+2], fcomp);
+            runs[k] = runs[i];
+        }
+        runs[k] = hi;
+        nruns = k;
+    }
+}
+
+/* one piece of a SORT_MERGE_PARALLEL sort */
+typedef struct {
+    data_t **a, **tmp;
+    int *runs;
+    int lo, hi;
+    int (*fcomp)(const data_t *, const data_t *);
+} ulist_sort_job_t;
+
+static void *ulist_sort_worker(void *arg)
+{
+    ulist_sort_job_t *job = (ulist_sort_job_t *) arg;
+    ulist_merge_sort(job->a, job->tmp, job->runs, job->lo, job->hi, job->fcomp);
+    return NULL;
+}
+
+/* Sorts the list with a stable merge sort.  sort_type is SORT_MERGE or
+ * SORT_MERGE_PARALLEL.  fcomp becomes the comparison procedure of the list,
+ * which is marked as sorted.
+ */
+void sort(list_t *list_ptr, int sort_type, int (*fcomp)(const data_t *, const data_t *))
+{
+    ulist_sort_job_t jobs[LIST_SORT_THREADS];
+    pthread_t threads[LIST_SORT_THREADS];
+    int started[LIST_SORT_THREADS];
+    int n, i, pieces = 1;
+    data_t **a, **tmp;
+    int *runs;
+    list_chunk_t *c;
+
+    assert(list_ptr != NULL && fcomp != NULL);
+    assert(sort_type == SORT_MERGE || sort_type == SORT_MERGE_PARALLEL);
+    n = list_ptr->current_list_size;
+    a = (data_t **) malloc((n + 1)*sizeof(data_t *));
+    tmp = (data_t **) malloc((n + 1)*sizeof(data_t *));
+    runs = (int *) malloc((n + LIST_SORT_THREADS + 1)*sizeof(int));
+    assert(a != NULL && tmp != NULL && runs != NULL);
+    for (i = 0, c = list_ptr->head; c != NULL; c = c->next) {
+        memcpy(a + i, c->slot, c->count*sizeof(data_t *));
+        i += c->count;
+    }
+
+    if (sort_type == SORT_MERGE_PARALLEL && n >= 2*LIST_SORT_THREADS)
+        pieces = LIST_SORT_THREADS;
+    for (i = 0; i < pieces; i++) {
+        jobs[i].a = a;
+        jobs[i].tmp = tmp;
+        jobs[i].fcomp = fcomp;
+        jobs[i].lo = (int) ((long) n*i/pieces);
+        jobs[i].hi = (int) ((long) n*(i + 1)/pieces);
+        jobs[i].runs = runs + jobs[i].lo + i;   // pieces never share a runs entry
+    }
+    for (i = 1; i < pieces; i++)
+        started[i] = pthread_create(&threads[i], NULL, ulist_sort_worker, &jobs[i]) == 0;
+    ulist_sort_worker(&jobs[0]);
+    for (i = 1; i < pieces; i++) {
+        if (started[i])
+            pthread_join(threads[i], NULL);
+        else
+            ulist_sort_worker(&jobs[i]);
+        ulist_merge(a, tmp, 0, jobs[i].lo, jobs[i].hi, fcomp);
+    }
+
+    for (i = 0, c = list_ptr->head; c != NULL; c = c->next) {
+        memcpy(c->slot, a + i, c->count*sizeof(data_t *));
+        i += c->count;
+    }
+    free(a);
+    free(tmp);
+    free(runs);
+    list_ptr->comp_proc = fcomp;
+    list_ptr->list_sorted_state = SORTED_LIST;
+    list_check(list_ptr);
+}
+
+/* Returns the number of elements in the list. */
+int list_size(list_t *list_ptr)
+{
+    assert(list_ptr != NULL);
+    assert(list_ptr->current_list_size >= 0);
+    return list_ptr->current_list_size;
+}
+
+/* Verifies the chunk links, that every chunk is aligned and holds between
+ * 1 and LIST_CHUNK_SLOTS elements, that the counts add up to the list
+ * size, and for a sorted list that the elements are in order.  Terminates
+ * the program with "Assertion failed:" if an error is found.
+ */
+void list_debug_validate(list_t *L)
+{
+    list_chunk_t *c;
+    data_t *last = NULL;
+    int count = 0;
+    int i;
+
+    assert(L != NULL);
+    assert(L->list_sorted_state == SORTED_LIST || L->list_sorted_state == UNSORTED_LIST);
+    if (L->head == NULL) {
+        assert(L->tail == NULL && L->current_list_size == 0);
+        return;
+    }
+    assert(L->head->prev == NULL && L->tail->next == NULL);
+    for (c = L->head; c != NULL; c = c->next) {
+        assert(((uintptr_t) c & (LIST_CHUNK_BYTES - 1)) == 0);
+        assert(0 < c->count && c->count <= (int) LIST_CHUNK_SLOTS);
+        if (c->next != NULL) assert(c->next->prev == c);
+        else assert(c == L->tail);
+        for (i = 0; i < c->count; i++) {
+            assert(c->slot[i] != NULL);
+            if (L->list_sorted_state == SORTED_LIST && last != NULL)
+                assert(L->comp_proc(last, c->slot[i]) != -1);
+            last = c->slot[i];
+        }
+        count += c->count;
+    }
+    assert(count == L->current_list_size);
+}
+/* commands for vim. ts: tabstop, sts: softtabstop sw: shiftwidth */
+/* vi:set ts=8 sts=4 sw=4 et: */